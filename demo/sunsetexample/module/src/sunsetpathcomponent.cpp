@@ -0,0 +1,66 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetpathcomponent.h"
+
+#include <entity.h>
+#include <nap/datetime.h>
+#include <algorithm>
+
+RTTI_BEGIN_CLASS(nap::SunPathComponent)
+	RTTI_PROPERTY("Calculator", &nap::SunPathComponent::mCalculator, nap::rtti::EPropertyMetaData::Required, "Calculator that provides the solar terms and sun position")
+	RTTI_PROPERTY("Mesh", &nap::SunPathComponent::mMesh, nap::rtti::EPropertyMetaData::Required, "Sun path mesh to update")
+	RTTI_PROPERTY("Marker", &nap::SunPathComponent::mMarker, nap::rtti::EPropertyMetaData::Default, "Optional transform moved to the current sun position on the path")
+RTTI_END_CLASS
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::SunPathComponentInstance)
+	RTTI_CONSTRUCTOR(nap::EntityInstance&, nap::Component&)
+RTTI_END_CLASS
+
+namespace nap
+{
+	/**
+	 * @return if both terms describe the same day and location
+	 */
+	static bool equalTerms(const sunset::SolarTerms& a, const sunset::SolarTerms& b)
+	{
+		return a.mLatitude == b.mLatitude && a.mLongitude == b.mLongitude && a.mTimezone == b.mTimezone &&
+			std::equal(std::begin(a.mDeclination), std::end(a.mDeclination), std::begin(b.mDeclination)) &&
+			std::equal(std::begin(a.mEquationOfTime), std::end(a.mEquationOfTime), std::begin(b.mEquationOfTime));
+	}
+
+
+	void SunPathComponent::getDependentComponents(std::vector<rtti::TypeInfo>& components) const
+	{
+		components.emplace_back(RTTI_OF(SunsetCalculatorComponent));
+	}
+
+
+	bool SunPathComponentInstance::init(utility::ErrorState& errorState)
+	{
+		mMesh = getComponent<SunPathComponent>()->mMesh.get();
+		mTerms = mCalculator->getSolarTerms();
+		mMesh->setPath(mTerms);
+		update(0.0);
+		return true;
+	}
+
+
+	void SunPathComponentInstance::update(double deltaTime)
+	{
+		// The calculator computes new terms on day rollover or when it moved far enough
+		const auto& terms = mCalculator->getSolarTerms();
+		if (!equalTerms(terms, mTerms))
+		{
+			mTerms = terms;
+			mMesh->setPath(mTerms);
+		}
+
+		double elevation, azimuth;
+		mCalculator->getSunPosition(getCurrentTime(), elevation, azimuth);
+		mPosition = mMesh->getPosition(elevation, azimuth);
+		if (mMarker.get() != nullptr)
+			mMarker->setTranslate(mPosition);
+	}
+}
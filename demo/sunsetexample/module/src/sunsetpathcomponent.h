@@ -0,0 +1,80 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <component.h>
+#include <componentptr.h>
+#include <transformcomponent.h>
+#include <sunsetcalculatorcomponent.h>
+
+#include "sunsetpathmesh.h"
+
+namespace nap
+{
+	class SunPathComponentInstance;
+
+	/**
+	 * Drives a nap::SunPathMesh from the solar terms of a nap::SunsetCalculatorComponent and moves a marker to the current sun position.
+	 * The path is only recomputed and uploaded when the calculator computes a new day or moves far enough to recompute it,
+	 * every other frame only the marker transform is updated. Give every site its own mesh to show many of them.
+	 */
+	class NAPAPI SunPathComponent : public Component
+	{
+		RTTI_ENABLE(Component)
+		DECLARE_COMPONENT(SunPathComponent, SunPathComponentInstance)
+	public:
+		ComponentPtr<SunsetCalculatorComponent> mCalculator;	///< Property: 'Calculator' calculator that provides the solar terms and sun position
+		ResourcePtr<SunPathMesh> mMesh;							///< Property: 'Mesh' sun path mesh to update
+		ComponentPtr<TransformComponent> mMarker;				///< Property: 'Marker' optional transform moved to the current sun position on the path
+
+		/**
+		 * The calculator is initialized first, it provides the solar terms.
+		 */
+		virtual void getDependentComponents(std::vector<rtti::TypeInfo>& components) const override;
+	};
+
+
+	/**
+	 * Rebuilds the sun path when the solar terms of the calculator change, moves the marker every update.
+	 */
+	class NAPAPI SunPathComponentInstance : public ComponentInstance
+	{
+		RTTI_ENABLE(ComponentInstance)
+	public:
+		SunPathComponentInstance(EntityInstance& entity, Component& resource) :
+			ComponentInstance(entity, resource)									{ }
+
+		/**
+		 * Computes the path of the current day and places the marker.
+		 * @param errorState contains the error if initialization fails
+		 * @return if initialization succeeded
+		 */
+		virtual bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Rebuilds the path when the day or location changed, moves the marker to the current sun position.
+		 * @param deltaTime time in between frames in seconds
+		 */
+		virtual void update(double deltaTime) override;
+
+		/**
+		 * @return the sun path mesh
+		 */
+		SunPathMesh& getMesh()								{ return *mMesh; }
+
+		/**
+		 * @return current position of the sun on the path
+		 */
+		const glm::vec3& getSunPosition() const				{ return mPosition; }
+
+		ComponentInstancePtr<SunsetCalculatorComponent> mCalculator = { this, &SunPathComponent::mCalculator };
+		ComponentInstancePtr<TransformComponent> mMarker = { this, &SunPathComponent::mMarker };
+
+	private:
+		SunPathMesh* mMesh = nullptr;
+		sunset::SolarTerms mTerms;							///< Solar terms the path is computed for
+		glm::vec3 mPosition = { 0.0f, 0.0f, 0.0f };			///< Current sun position on the path
+	};
+}
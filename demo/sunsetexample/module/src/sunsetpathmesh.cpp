@@ -0,0 +1,88 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetpathmesh.h"
+
+#include <renderservice.h>
+#include <meshutils.h>
+#include <nap/core.h>
+#include <nap/logger.h>
+#include <cmath>
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::SunPathMesh)
+	RTTI_CONSTRUCTOR(nap::Core&)
+	RTTI_PROPERTY("SampleCount", &nap::SunPathMesh::mSampleCount, nap::rtti::EPropertyMetaData::Default, "Number of points along the path, 145 is every 10 minutes")
+	RTTI_PROPERTY("Radius", &nap::SunPathMesh::mRadius, nap::rtti::EPropertyMetaData::Default, "Distance of the path to the origin")
+RTTI_END_CLASS
+
+namespace nap
+{
+	static constexpr double degToRad = 3.14159265358979323846 / 180.0;
+
+
+	SunPathMesh::SunPathMesh(Core& core) :
+		mRenderService(core.getService<RenderService>())
+	{ }
+
+
+	bool SunPathMesh::init(utility::ErrorState& errorState)
+	{
+		if (!errorState.check(mSampleCount >= 2, "%s: sun path needs at least 2 samples", mID.c_str()))
+			return false;
+
+		if (!errorState.check(mRadius > 0.0f, "%s: radius must be positive: %f", mID.c_str(), mRadius))
+			return false;
+
+		// Only uploaded when the day or location changes, never per frame
+		mMeshInstance = std::make_unique<MeshInstance>(*mRenderService);
+		mMeshInstance->setNumVertices(mSampleCount);
+		mMeshInstance->setDrawMode(EDrawMode::LineStrip);
+		mMeshInstance->setCullMode(ECullMode::None);
+		mMeshInstance->setUsage(EMemoryUsage::DynamicWrite);
+		mPositions = &mMeshInstance->getOrCreateAttribute<glm::vec3>(vertexid::position);
+
+		MeshShape& shape = mMeshInstance->createShape();
+		utility::generateIndices(shape, mSampleCount);
+
+		computePath(sunset::SolarTerms());
+		mUploadCount = 0;
+		return mMeshInstance->init(errorState);
+	}
+
+
+	void SunPathMesh::setPath(const sunset::SolarTerms& terms)
+	{
+		computePath(terms);
+		utility::ErrorState error;
+		if (!mMeshInstance->update(error))
+		{
+			nap::Logger::warn("%s: unable to upload sun path: %s", mID.c_str(), error.toString().c_str());
+			return;
+		}
+		mUploadCount++;
+	}
+
+
+	glm::vec3 SunPathMesh::getPosition(double elevation, double azimuth) const
+	{
+		double el = elevation * degToRad;
+		double az = azimuth * degToRad;
+		double horizontal = std::cos(el) * mRadius;
+		return { static_cast<float>(std::sin(az) * horizontal), static_cast<float>(std::sin(el) * mRadius), static_cast<float>(-std::cos(az) * horizontal) };
+	}
+
+
+	void SunPathMesh::computePath(const sunset::SolarTerms& terms)
+	{
+		std::vector<glm::vec3> positions(mSampleCount);
+		double step = 1440.0 / (mSampleCount - 1);
+		for (int i = 0; i < mSampleCount; i++)
+		{
+			double elevation, azimuth;
+			sunset::calcSolarPosition(terms, i * step, elevation, azimuth);
+			positions[i] = getPosition(elevation, azimuth);
+		}
+		mPositions->setData(positions);
+	}
+}
@@ -0,0 +1,74 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <mesh.h>
+#include <sunsethorizon.h>
+
+namespace nap
+{
+	class RenderService;
+
+	/**
+	 * Line strip of the path of the sun over a day, sampled evenly from local midnight to midnight.
+	 * The path is a circle around the origin: y is up, -z is north and x is east, below the horizon included.
+	 * The vertices are only computed and uploaded on setPath(), use a nap::SunPathComponent to drive it from a calculator.
+	 */
+	class NAPAPI SunPathMesh : public IMesh
+	{
+		RTTI_ENABLE(IMesh)
+	public:
+		SunPathMesh(Core& core);
+
+		int mSampleCount = 145;						///< Property: 'SampleCount' number of points along the path, 145 is every 10 minutes
+		float mRadius = 4.0f;						///< Property: 'Radius' distance of the path to the origin
+
+		/**
+		 * Creates the mesh with the path of the sun on the equator at the equinox.
+		 * @param errorState contains the error if the mesh can't be created
+		 * @return if the mesh is created
+		 */
+		virtual bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Recomputes the path for the solar terms of a day and uploads it.
+		 * @param terms solar terms of the day, including location
+		 */
+		void setPath(const sunset::SolarTerms& terms);
+
+		/**
+		 * @param elevation sun elevation in degrees
+		 * @param azimuth sun azimuth in degrees, 0 = north, 90 = east
+		 * @return position of the sun on the path
+		 */
+		glm::vec3 getPosition(double elevation, double azimuth) const;
+
+		/**
+		 * @return number of times the path was uploaded since init
+		 */
+		int getUploadCount() const					{ return mUploadCount; }
+
+		/**
+		 * @return the mesh instance
+		 */
+		virtual MeshInstance& getMeshInstance() override				{ return *mMeshInstance; }
+
+		/**
+		 * @return the mesh instance
+		 */
+		virtual const MeshInstance& getMeshInstance() const override	{ return *mMeshInstance; }
+
+	private:
+		/**
+		 * Computes the vertices of the path
+		 */
+		void computePath(const sunset::SolarTerms& terms);
+
+		RenderService* mRenderService = nullptr;
+		std::unique_ptr<MeshInstance> mMeshInstance;
+		Vec3VertexAttribute* mPositions = nullptr;	///< Position of every sample
+		int mUploadCount = 0;						///< Number of uploads since init
+	};
+}
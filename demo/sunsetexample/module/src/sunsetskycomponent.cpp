@@ -0,0 +1,49 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetskycomponent.h"
+
+#include <entity.h>
+#include <nap/datetime.h>
+#include <cmath>
+
+RTTI_BEGIN_CLASS(nap::SkyColorComponent)
+	RTTI_PROPERTY("Calculator", &nap::SkyColorComponent::mCalculator, nap::rtti::EPropertyMetaData::Required, "Calculator that provides the sun position")
+	RTTI_PROPERTY("Texture", &nap::SkyColorComponent::mTexture, nap::rtti::EPropertyMetaData::Required, "Sky color texture to update")
+	RTTI_PROPERTY("Threshold", &nap::SkyColorComponent::mThreshold, nap::rtti::EPropertyMetaData::Default, "Sun elevation change in degrees before the texture is recomputed")
+RTTI_END_CLASS
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::SkyColorComponentInstance)
+	RTTI_CONSTRUCTOR(nap::EntityInstance&, nap::Component&)
+RTTI_END_CLASS
+
+namespace nap
+{
+	void SkyColorComponent::getDependentComponents(std::vector<rtti::TypeInfo>& components) const
+	{
+		components.emplace_back(RTTI_OF(SunsetCalculatorComponent));
+	}
+
+
+	bool SkyColorComponentInstance::init(utility::ErrorState& errorState)
+	{
+		auto* resource = getComponent<SkyColorComponent>();
+		mTexture = resource->mTexture.get();
+		mThreshold = resource->mThreshold;
+		if (!errorState.check(mThreshold >= 0.0f, "%s: threshold must be positive: %f", mID.c_str(), mThreshold))
+			return false;
+
+		mCalculator->getSunPosition(getCurrentTime(), mElevation, mAzimuth);
+		mTexture->setSunElevation(mElevation);
+		return true;
+	}
+
+
+	void SkyColorComponentInstance::update(double deltaTime)
+	{
+		mCalculator->getSunPosition(getCurrentTime(), mElevation, mAzimuth);
+		if (std::abs(mElevation - mTexture->getSunElevation()) > mThreshold)
+			mTexture->setSunElevation(mElevation);
+	}
+}
@@ -0,0 +1,84 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <component.h>
+#include <componentptr.h>
+#include <sunsetcalculatorcomponent.h>
+
+#include "sunsetskytexture.h"
+
+namespace nap
+{
+	class SkyColorComponentInstance;
+
+	/**
+	 * Drives a nap::SkyColorTexture from the sun position of a nap::SunsetCalculatorComponent.
+	 * The texture is only recomputed when the sun elevation moves more than 'Threshold' degrees.
+	 */
+	class NAPAPI SkyColorComponent : public Component
+	{
+		RTTI_ENABLE(Component)
+		DECLARE_COMPONENT(SkyColorComponent, SkyColorComponentInstance)
+	public:
+		ComponentPtr<SunsetCalculatorComponent> mCalculator;	///< Property: 'Calculator' calculator that provides the sun position
+		ResourcePtr<SkyColorTexture> mTexture;					///< Property: 'Texture' sky color texture to update
+		float mThreshold = 0.25f;								///< Property: 'Threshold' sun elevation change in degrees before the texture is recomputed
+
+		/**
+		 * The calculator is initialized first, it provides the sun position.
+		 */
+		virtual void getDependentComponents(std::vector<rtti::TypeInfo>& components) const override;
+	};
+
+
+	/**
+	 * Recomputes the sky color texture when the sun elevation moves more than the threshold.
+	 * Use getSunElevation() and getSunAzimuth() to compute the angle between the view direction and the sun in the shader.
+	 */
+	class NAPAPI SkyColorComponentInstance : public ComponentInstance
+	{
+		RTTI_ENABLE(ComponentInstance)
+	public:
+		SkyColorComponentInstance(EntityInstance& entity, Component& resource) :
+			ComponentInstance(entity, resource)									{ }
+
+		/**
+		 * Computes the sky colors of the current sun position.
+		 * @param errorState contains the error if initialization fails
+		 * @return if initialization succeeded
+		 */
+		virtual bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Updates the sun position, recomputes the texture when the elevation moved past the threshold.
+		 * @param deltaTime time in between frames in seconds
+		 */
+		virtual void update(double deltaTime) override;
+
+		/**
+		 * @return current sun elevation in degrees
+		 */
+		double getSunElevation() const						{ return mElevation; }
+
+		/**
+		 * @return current sun azimuth in degrees, 0 = north, 90 = east
+		 */
+		double getSunAzimuth() const						{ return mAzimuth; }
+
+		/**
+		 * @return the sky color texture
+		 */
+		SkyColorTexture& getTexture()						{ return *mTexture; }
+
+		ComponentInstancePtr<SunsetCalculatorComponent> mCalculator = { this, &SkyColorComponent::mCalculator };
+
+	private:
+		SkyColorTexture* mTexture = nullptr;
+		float mThreshold = 0.25f;
+		double mElevation = 0.0;
+		double mAzimuth = 0.0;
+	};
+}
@@ -0,0 +1,58 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetskytexture.h"
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::SkyColorTexture)
+	RTTI_CONSTRUCTOR(nap::Core&)
+	RTTI_PROPERTY("Width", &nap::SkyColorTexture::mWidth, nap::rtti::EPropertyMetaData::Default, "Number of view zenith angle samples")
+	RTTI_PROPERTY("Height", &nap::SkyColorTexture::mHeight, nap::rtti::EPropertyMetaData::Default, "Number of sun angle samples")
+	RTTI_PROPERTY("Turbidity", &nap::SkyColorTexture::mTurbidity, nap::rtti::EPropertyMetaData::Default, "Haziness of the atmosphere, 2 (clear) to 10 (hazy)")
+	RTTI_PROPERTY("Exposure", &nap::SkyColorTexture::mExposure, nap::rtti::EPropertyMetaData::Default, "Scales luminance in kcd/m2 before tone mapping")
+	RTTI_PROPERTY("Twilight", &nap::SkyColorTexture::mTwilight, nap::rtti::EPropertyMetaData::Default, "Sun depression in degrees at which the sky is black")
+	RTTI_PROPERTY("SunElevation", &nap::SkyColorTexture::mSunElevation, nap::rtti::EPropertyMetaData::Default, "Initial sun elevation in degrees")
+RTTI_END_CLASS
+
+namespace nap
+{
+	SkyColorTexture::SkyColorTexture(Core& core) :
+		Texture2D(core)
+	{ }
+
+
+	bool SkyColorTexture::init(utility::ErrorState& errorState)
+	{
+		if (!errorState.check(mWidth >= 2 && mHeight >= 2, "%s: sky texture must be at least 2x2", mID.c_str()))
+			return false;
+
+		if (!errorState.check(mTurbidity >= 1.0f, "%s: turbidity must be at least 1: %f", mID.c_str(), mTurbidity))
+			return false;
+
+		// Updated from the CPU whenever the sun moves
+		mUsage = ETextureUsage::DynamicWrite;
+		mElevation = mSunElevation;
+		sunset::computeSkyColors(mElevation, getSettings(), mWidth, mHeight, mPixels);
+
+		SurfaceDescriptor descriptor(mWidth, mHeight, ESurfaceDataType::FLOAT, ESurfaceChannels::RGBA);
+		return Texture2D::init(descriptor, false, mPixels.data(), 0, errorState);
+	}
+
+
+	void SkyColorTexture::setSunElevation(double elevation)
+	{
+		mElevation = elevation;
+		sunset::computeSkyColors(mElevation, getSettings(), mWidth, mHeight, mPixels);
+		update(mPixels.data(), SurfaceDescriptor(mWidth, mHeight, ESurfaceDataType::FLOAT, ESurfaceChannels::RGBA));
+	}
+
+
+	sunset::SkySettings SkyColorTexture::getSettings() const
+	{
+		sunset::SkySettings settings;
+		settings.mTurbidity = mTurbidity;
+		settings.mExposure = mExposure;
+		settings.mTwilight = mTwilight;
+		return settings;
+	}
+}
@@ -0,0 +1,58 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <texture.h>
+#include <sunsetsky.h>
+
+namespace nap
+{
+	/**
+	 * Small sky color lookup texture for rendering a sky backdrop that matches the sun, computed on the CPU
+	 * from the Preetham daylight model. Shaders look up the color of a view direction with
+	 * u = zenith angle of the view direction / 90 degrees and v = angle between the view direction and the sun / 180 degrees.
+	 * The texture is only recomputed on setSunElevation(), use a nap::SkyColorComponent to drive it from a calculator.
+	 */
+	class NAPAPI SkyColorTexture : public Texture2D
+	{
+		RTTI_ENABLE(Texture2D)
+	public:
+		SkyColorTexture(Core& core);
+
+		int mWidth = 64;							///< Property: 'Width' number of view zenith angle samples
+		int mHeight = 64;							///< Property: 'Height' number of sun angle samples
+		float mTurbidity = 3.0f;					///< Property: 'Turbidity' haziness of the atmosphere, 2 (clear) to 10 (hazy)
+		float mExposure = 0.1f;						///< Property: 'Exposure' scales luminance in kcd/m2 before tone mapping
+		float mTwilight = 12.0f;					///< Property: 'Twilight' sun depression in degrees at which the sky is black
+		float mSunElevation = 30.0f;				///< Property: 'SunElevation' initial sun elevation in degrees
+
+		/**
+		 * Computes the initial sky colors and creates the texture.
+		 * @param errorState contains the error if the texture can't be created
+		 * @return if the texture is created
+		 */
+		virtual bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Recomputes the sky colors for a new sun elevation and uploads them.
+		 * @param elevation sun elevation in degrees
+		 */
+		void setSunElevation(double elevation);
+
+		/**
+		 * @return sun elevation in degrees the colors are computed for
+		 */
+		double getSunElevation() const				{ return mElevation; }
+
+	private:
+		/**
+		 * @return model settings from the properties
+		 */
+		sunset::SkySettings getSettings() const;
+
+		std::vector<float> mPixels;					///< RGBA float pixels
+		double mElevation = 0.0;					///< Sun elevation the pixels are computed for
+	};
+}
@@ -10,6 +10,7 @@
 #include <inputrouter.h>
 #include <rendergnomoncomponent.h>
 #include <perspcameracomponent.h>
+#include <renderablemeshcomponent.h>
 #include <imgui/imgui.h>
 
 RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::SunsetExampleApp)
@@ -58,6 +59,15 @@ namespace nap
 		if (!error.check(mGnomonEntity != nullptr, "unable to find entity with name: %s", "SunsetEntity"))
 			return false;
 
+		// Get the sun path and marker entities
+		mSunPathEntity = mScene->findEntity("SunPathEntity");
+		if (!error.check(mSunPathEntity != nullptr, "unable to find entity with name: %s", "SunPathEntity"))
+			return false;
+
+		mSunMarkerEntity = mScene->findEntity("SunMarkerEntity");
+		if (!error.check(mSunMarkerEntity != nullptr, "unable to find entity with name: %s", "SunMarkerEntity"))
+			return false;
+
 		// All done!
 		return true;
 	}
@@ -70,6 +80,11 @@ namespace nap
 		nap::DefaultInputRouter input_router(true);
 		mInputService->processWindowEvents(*mRenderWindow, input_router, { &mScene->getRootEntity() });
 		auto& sunset = mSunsetEntity->getComponent<SunsetCalculatorComponentInstance>();
+		auto& power = mSunsetEntity->getComponent<SunsetPowerComponentInstance>();
+
+		// Don't build the GUI when the active power profile hides it, render() still draws the (empty) GUI frame
+		if (power.isGuiSuspended())
+			return;
 
 		// Select GUI window
 		mGuiService->selectWindow(mRenderWindow);
@@ -86,6 +101,8 @@ namespace nap
 		ImGui::TextColored(theme.mHighlightColor3, "Sunset:  %s", sunset.getSunSet().toString().c_str());
 		ImGui::Text("lat: %.2f, lon: %.2f", sunset.getLatitude(), sunset.getLongitude());
 		ImGui::Text(utility::stringFormat("Framerate: %.02f", getCore().getFramerate()).c_str());
+		ImGui::Text("Profile: %s, saved: %.0fs, %.0fJ", power.isNight() ? "Night" : "Day", power.getTimeSaved(), power.getEnergySaved());
+		ImGui::Text("Sun path uploads: %d", mSunsetEntity->getComponent<SunPathComponentInstance>().getMesh().getUploadCount());
 		ImGui::End();
 	}
 
@@ -107,16 +124,18 @@ namespace nap
 			// Get Perspective camera to render with
 			auto& perp_cam = mCameraEntity->getComponent<PerspCameraComponentInstance>();
 
-			// Add Gnomon
+			// Add Gnomon, sun path and sun
 			std::vector<nap::RenderableComponentInstance*> components_to_render
 			{
-				&mGnomonEntity->getComponent<RenderGnomonComponentInstance>()
+				&mGnomonEntity->getComponent<RenderGnomonComponentInstance>(),
+				&mSunPathEntity->getComponent<RenderableMeshComponentInstance>(),
+				&mSunMarkerEntity->getComponent<RenderableMeshComponentInstance>()
 			};
 
-			// Render Gnomon
+			// Render Gnomon, sun path and sun
 			mRenderService->renderObjects(*mRenderWindow, perp_cam, components_to_render);
 
-			// Render GUI elements
+			// Render GUI elements, always drawn to complete the GUI frame, empty when suspended
 			mGuiService->draw();
 
 			// Stop render pass
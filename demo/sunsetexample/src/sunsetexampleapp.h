@@ -18,6 +18,8 @@
 #include <entity.h>
 #include <app.h>
 #include <sunsetcalculatorcomponent.h>
+#include <sunsetpowercomponent.h>
+#include <sunsetpathcomponent.h>
 
 namespace nap
 {
@@ -83,5 +85,7 @@ namespace nap
 		ObjectPtr<EntityInstance>	mCameraEntity = nullptr;		///< Pointer to the entity that holds the perspective camera
 		ObjectPtr<EntityInstance>	mGnomonEntity = nullptr;		///< Pointer to the entity that can render the gnomon
 		ObjectPtr<EntityInstance>	mSunsetEntity = nullptr;		///< Pointer to the entity holding the sunset calculator
+		ObjectPtr<EntityInstance>	mSunPathEntity = nullptr;		///< Pointer to the entity that renders the sun path
+		ObjectPtr<EntityInstance>	mSunMarkerEntity = nullptr;		///< Pointer to the entity that renders the sun on its path
 	};
 }
@@ -0,0 +1,33 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "sunsetheadlessapp.h"
+
+// Nap includes
+#include <nap/core.h>
+#include <nap/logger.h>
+#include <apprunner.h>
+#include <appeventhandler.h>
+
+// Main loop
+int main(int argc, char *argv[])
+{
+	// Create core
+	nap::Core core;
+
+	// Create app runner, no window or input
+	nap::AppRunner<nap::SunsetHeadlessApp, nap::AppEventHandler> app_runner(core);
+
+	// Start
+	nap::utility::ErrorState error;
+	if (!app_runner.start(error))
+	{
+		nap::Logger::fatal("error: %s", error.toString().c_str());
+		return -1;
+	}
+
+	// Return if the app ran successfully
+	return app_runner.exitCode();
+}
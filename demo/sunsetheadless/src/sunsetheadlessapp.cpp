@@ -0,0 +1,68 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetheadlessapp.h"
+
+// External Includes
+#include <nap/logger.h>
+#include <chrono>
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::SunsetHeadlessApp)
+	RTTI_CONSTRUCTOR(nap::Core&)
+RTTI_END_CLASS
+
+namespace nap
+{
+	bool SunsetHeadlessApp::init(utility::ErrorState& error)
+	{
+		// Retrieve services
+		mSceneService	= getCore().getService<nap::SceneService>();
+		mSunsetService	= getCore().getService<nap::SunsetService>();
+
+		// Fetch the resource manager
+		mResourceManager = getCore().getResourceManager();
+
+		// Get the scene
+		mScene = mResourceManager->findObject<Scene>("Scene");
+		if (!error.check(mScene != nullptr, "unable to find scene with name: %s", "Scene"))
+			return false;
+
+		// Get the entity that holds the calculator
+		mSunsetEntity = mScene->findEntity("SunsetEntity");
+		if (!error.check(mSunsetEntity != nullptr, "unable to find entity with name: %s", "SunsetEntity"))
+			return false;
+
+		auto& calculator = mSunsetEntity->getComponent<SunsetCalculatorComponentInstance>();
+		calculator.mSunStateChanged.connect(mSunStateChangedSlot);
+		return true;
+	}
+
+
+	void SunsetHeadlessApp::update(double deltaTime)
+	{
+		// Wait until the next event is due, transitions fired by the timer thread are delivered when it wakes
+		auto start = std::chrono::steady_clock::now();
+		mSunsetService->waitForNextEvent(mMaxSleep);
+		mSleepTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		mSleepCount++;
+	}
+
+
+	void SunsetHeadlessApp::onSunStateChanged(SunsetCalculatorComponentInstance::EState state)
+	{
+		auto& calculator = mSunsetEntity->getComponent<SunsetCalculatorComponentInstance>();
+		DateTime time(calculator.getStateTimeStamp(), DateTime::ConversionMode::Local);
+		nap::Logger::info("sun %s at %02d:%02d:%02d, slept %.0f seconds in %d frames",
+			state == SunsetCalculatorComponentInstance::EState::Up ? "up" : "down",
+			time.getHour(), time.getMinute(), time.getSecond(), mSleepTime, mSleepCount);
+		mSleepTime = 0.0;
+		mSleepCount = 0;
+	}
+
+
+	int SunsetHeadlessApp::shutdown()
+	{
+		return 0;
+	}
+}
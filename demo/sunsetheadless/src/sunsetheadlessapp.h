@@ -0,0 +1,80 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// Core includes
+#include <nap/resourcemanager.h>
+#include <nap/resourceptr.h>
+
+// Module includes
+#include <sceneservice.h>
+#include <scene.h>
+#include <entity.h>
+#include <app.h>
+#include <sunsetservice.h>
+#include <sunsetcalculatorcomponent.h>
+
+namespace nap
+{
+	using namespace rtti;
+
+	/**
+	 * Headless sunset controller that sleeps between events.
+	 * Every frame the app waits in the sunset service until the next sunrise, sunset, elevation crossing
+	 * or day rollover of any calculator. The service timer thread wakes it at the exact time of a transition,
+	 * which is delivered before the wait returns.
+	 */
+	class SunsetHeadlessApp : public App
+	{
+		RTTI_ENABLE(App)
+	public:
+		/**
+		 * Constructor
+		 * @param core instance of the NAP core system
+		 */
+		SunsetHeadlessApp(nap::Core& core) : App(core) { }
+
+		/**
+		 * Initialize all the services and app specific data structures
+		 * @param error contains the error code when initialization fails
+		 * @return if initialization succeeded
+		*/
+		bool init(utility::ErrorState& error) override;
+
+		/**
+		 * Update is called every frame, waits until the next sunset event.
+		 * @param deltaTime the time in seconds between calls
+		 */
+		void update(double deltaTime) override;
+
+		/**
+		 * Nothing to render
+		 */
+		void render() override										{ }
+
+		/**
+		 * Called when the app is shutting down after quit() has been invoked
+		 * @return the application exit code, this is returned when the main loop is exited
+		 */
+		virtual int shutdown() override;
+
+	private:
+		/**
+		 * Logs sunrise and sunset
+		 */
+		void onSunStateChanged(SunsetCalculatorComponentInstance::EState state);
+		Slot<SunsetCalculatorComponentInstance::EState> mSunStateChangedSlot = { this, &SunsetHeadlessApp::onSunStateChanged };
+
+		ResourceManager*			mResourceManager = nullptr;		///< Manages all the loaded data
+		SceneService*				mSceneService = nullptr;		///< Manages all the objects in the scene
+		SunsetService*				mSunsetService = nullptr;		///< Waits for the next event
+		ObjectPtr<Scene>			mScene = nullptr;				///< Pointer to the main scene
+		ObjectPtr<EntityInstance>	mSunsetEntity = nullptr;		///< Entity that holds the calculator
+
+		double mMaxSleep = 10.0;						///< Max seconds waited in a single frame, bounds the delay of quitting and clock changes
+		double mSleepTime = 0.0;						///< Total seconds waited since the last log
+		int mSleepCount = 0;							///< Number of frames waited since the last log
+	};
+}
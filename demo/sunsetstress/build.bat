@@ -0,0 +1,5 @@
+@echo off
+set PYTHONPATH=
+set PYTHONHOME=
+set python=%~dp0\..\..\thirdparty\python\msvc\x86_64\python
+%python% %~dp0\..\..\tools\buildsystem\common\build_app_by_dir.py %~dp0 %*
@@ -0,0 +1,256 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetstressapp.h"
+
+// External Includes
+#include <utility/fileutils.h>
+#include <utility/stringutils.h>
+#include <nap/logger.h>
+#include <inputrouter.h>
+#include <imgui/imgui.h>
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::SunsetStressApp)
+	RTTI_CONSTRUCTOR(nap::Core&)
+RTTI_END_CLASS
+
+namespace nap
+{
+	// Formats the time of day as hh:mm:ss
+	static std::string formatTime(const DateTime& time)
+	{
+		return utility::stringFormat("%02d:%02d:%02d", time.getHour(), time.getMinute(), time.getSecond());
+	}
+
+
+	bool SunsetStressApp::init(utility::ErrorState& error)
+	{
+		// Retrieve services
+		mRenderService	= getCore().getService<nap::RenderService>();
+		mSceneService	= getCore().getService<nap::SceneService>();
+		mInputService	= getCore().getService<nap::InputService>();
+		mGuiService		= getCore().getService<nap::IMGuiService>();
+
+		// Fetch the resource manager
+		mResourceManager = getCore().getResourceManager();
+
+		// Get the render window
+		mRenderWindow = mResourceManager->findObject<nap::RenderWindow>("Window");
+		if (!error.check(mRenderWindow != nullptr, "unable to find render window with name: %s", "Window"))
+			return false;
+
+		// Get the scene calculators are spawned in
+		mScene = mResourceManager->findObject<Scene>("Scene");
+		if (!error.check(mScene != nullptr, "unable to find scene with name: %s", "Scene"))
+			return false;
+
+		// Spawn the initial grid
+		return spawnCalculators(mGridRows, mGridColumns, error);
+	}
+
+
+	bool SunsetStressApp::spawnCalculators(int rows, int columns, utility::ErrorState& error)
+	{
+		destroyCalculators();
+
+		size_t count = static_cast<size_t>(rows) * static_cast<size_t>(columns);
+		mCalculatorResources.reserve(count);
+		mEntityResources.reserve(count);
+		mSpawnedEntities.reserve(count);
+		mRows.reserve(count);
+
+		// Cell centers, timezone follows longitude
+		for (int r = 0; r < rows; r++)
+		{
+			double latitude = -90.0 + (r + 0.5) * 180.0 / rows;
+			for (int c = 0; c < columns; c++)
+			{
+				double longitude = -180.0 + (c + 0.5) * 360.0 / columns;
+				std::string id = utility::stringFormat("Calculator_%d_%d", r, c);
+
+				auto component = std::make_unique<SunsetCalculatorComponent>();
+				component->mID = id;
+				component->mLatitude = latitude;
+				component->mLongitude = longitude;
+				component->mTimezone = std::round(longitude / 15.0);
+				if (!component->init(error))
+					return false;
+
+				auto entity = std::make_unique<Entity>();
+				entity->mID = utility::stringFormat("%sEntity", id.c_str());
+				entity->mComponents.emplace_back(component.get());
+				if (!entity->init(error))
+					return false;
+
+				SpawnedEntityInstance spawned = mScene->spawn(*entity, error);
+				if (!error.check(spawned.get() != nullptr, "unable to spawn entity: %s", entity->mID.c_str()))
+					return false;
+
+				auto& calculator = spawned->getComponent<SunsetCalculatorComponentInstance>();
+				mGroup.add(calculator);
+
+				Row row;
+				row.mCalculator = &calculator;
+				row.mLocation = utility::stringFormat("%7.2f, %7.2f", latitude, longitude);
+				mRows.emplace_back(std::move(row));
+
+				mCalculatorResources.emplace_back(std::move(component));
+				mEntityResources.emplace_back(std::move(entity));
+				mSpawnedEntities.emplace_back(spawned);
+			}
+		}
+
+		nap::Logger::info("Spawned %d sunset calculators", static_cast<int>(count));
+		return true;
+	}
+
+
+	void SunsetStressApp::destroyCalculators()
+	{
+		mGroup.clear();
+		for (auto& spawned : mSpawnedEntities)
+			mScene->destroy(spawned);
+
+		mRows.clear();
+		mSpawnedEntities.clear();
+		mEntityResources.clear();
+		mCalculatorResources.clear();
+	}
+
+
+	// Update app
+	void SunsetStressApp::update(double deltaTime)
+	{
+		// Use a default input router to forward input events (recursively) to all input components in the default scene
+		nap::DefaultInputRouter input_router(true);
+		mInputService->processWindowEvents(*mRenderWindow, input_router, { &mScene->getRootEntity() });
+
+		// Only visits calculators that transitioned since last frame
+		mGroup.update(getCurrentTime());
+		mFrameTime = math::lerp<double>(mFrameTime, deltaTime * 1000.0, 0.05);
+
+		// Select GUI window
+		mGuiService->selectWindow(mRenderWindow);
+
+		// Statistics and grid controls
+		const auto& theme = mGuiService->getPalette();
+		ImGui::Begin("Sunset Stress");
+		ImGui::Text(getCurrentDateTime().toString().c_str());
+		ImGui::Text("Calculators: %d", static_cast<int>(mRows.size()));
+		ImGui::TextColored(theme.mHighlightColor2, "Sun up: %d (%.1f%%)", mGroup.getUpCount(), mGroup.getUpFraction() * 100.0f);
+		ImGui::TextColored(theme.mHighlightColor4, "Sun down: %d", mGroup.getDownCount());
+		ImGui::Text("Frame time: %.02f ms, framerate: %.02f", mFrameTime, getCore().getFramerate());
+
+		ImGui::SliderInt("Rows", &mGridRows, 1, 360);
+		ImGui::SliderInt("Columns", &mGridColumns, 1, 720);
+		if (ImGui::Button("Respawn"))
+		{
+			utility::ErrorState error;
+			if (!spawnCalculators(mGridRows, mGridColumns, error))
+				nap::Logger::error(error.toString());
+		}
+
+		// Virtualized table: only visible rows are drawn and refreshed
+		if (ImGui::BeginTable("Calculators", 4, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+		{
+			ImGui::TableSetupScrollFreeze(0, 1);
+			ImGui::TableSetupColumn("Location");
+			ImGui::TableSetupColumn("State");
+			ImGui::TableSetupColumn("Sunrise");
+			ImGui::TableSetupColumn("Sunset");
+			ImGui::TableHeadersRow();
+
+			ImGuiListClipper clipper;
+			clipper.Begin(static_cast<int>(mRows.size()));
+			while (clipper.Step())
+			{
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+				{
+					// Rebuild strings when the calculator moved on to a new state or day
+					auto& row = mRows[i];
+					const auto& calculator = *row.mCalculator;
+					SystemTimeStamp sunrise = calculator.getSunRise().getTimeStamp();
+					if (row.mState != calculator.getState() || row.mSunRiseStamp != sunrise)
+					{
+						row.mState = calculator.getState();
+						row.mSunRiseStamp = sunrise;
+						row.mSunRise = formatTime(calculator.getSunRise());
+						row.mSunSet = formatTime(calculator.getSunSet());
+					}
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(row.mLocation.c_str());
+					ImGui::TableNextColumn();
+					bool is_up = row.mState == SunsetCalculatorComponentInstance::EState::Up;
+					ImGui::TextColored(is_up ? theme.mHighlightColor2 : theme.mHighlightColor4, is_up ? "Up" : "Down");
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(row.mSunRise.c_str());
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(row.mSunSet.c_str());
+				}
+			}
+			ImGui::EndTable();
+		}
+		ImGui::End();
+	}
+
+
+	// Render app
+	void SunsetStressApp::render()
+	{
+		// Signal the beginning of a new frame, allowing it to be recorded.
+		mRenderService->beginFrame();
+
+		// Begin recording the render commands for the main render window
+		if (mRenderService->beginRecording(*mRenderWindow))
+		{
+			// Begin render pass
+			mRenderWindow->beginRendering();
+
+			// Render GUI elements
+			mGuiService->draw();
+
+			// Stop render pass
+			mRenderWindow->endRendering();
+
+			// End recording
+			mRenderService->endRecording();
+		}
+
+		// Proceed to next frame
+		mRenderService->endFrame();
+	}
+
+
+	void SunsetStressApp::windowMessageReceived(WindowEventPtr windowEvent)
+	{
+		mRenderService->addEvent(std::move(windowEvent));
+	}
+
+
+	void SunsetStressApp::inputMessageReceived(InputEventPtr inputEvent)
+	{
+		if (inputEvent->get_type().is_derived_from(RTTI_OF(nap::KeyPressEvent)))
+		{
+			// If we pressed escape, quit the loop
+			nap::KeyPressEvent* press_event = static_cast<nap::KeyPressEvent*>(inputEvent.get());
+			if (press_event->mKey == nap::EKeyCode::KEY_ESCAPE)
+				quit();
+
+			// f is pressed, toggle full-screen
+			if (press_event->mKey == nap::EKeyCode::KEY_f)
+				mRenderWindow->toggleFullscreen();
+		}
+		// Add event, so it can be forwarded on update
+		mInputService->addEvent(std::move(inputEvent));
+	}
+
+
+	int SunsetStressApp::shutdown()
+	{
+		destroyCalculators();
+		return 0;
+	}
+}
@@ -0,0 +1,119 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// Core includes
+#include <nap/resourcemanager.h>
+#include <nap/resourceptr.h>
+
+// Module includes
+#include <renderservice.h>
+#include <imguiservice.h>
+#include <sceneservice.h>
+#include <inputservice.h>
+#include <scene.h>
+#include <renderwindow.h>
+#include <entity.h>
+#include <app.h>
+#include <sunsetcalculatorcomponent.h>
+#include <sunsetsitegroup.h>
+
+namespace nap
+{
+	using namespace rtti;
+
+	/**
+	 * Spawns a grid of sunset calculators over the globe and lists them in a virtualized table.
+	 * Serves as a scaling reference: only the visible rows are drawn and
+	 * row strings are rebuilt only when the state of a calculator changes.
+	 */
+	class SunsetStressApp : public App
+	{
+		RTTI_ENABLE(App)
+	public:
+		/**
+		 * Constructor
+		 * @param core instance of the NAP core system
+		 */
+		SunsetStressApp(nap::Core& core) : App(core) { }
+
+		/**
+		 * Initialize all the services and app specific data structures
+		 * @param error contains the error code when initialization fails
+		 * @return if initialization succeeded
+		*/
+		bool init(utility::ErrorState& error) override;
+
+		/**
+		 * Update is called every frame, before render.
+		 * @param deltaTime the time in seconds between calls
+		 */
+		void update(double deltaTime) override;
+
+		/**
+		 * Render is called after update. Use this call to render objects to a specific target
+		 */
+		void render() override;
+
+		/**
+		 * Called when the app receives a window message.
+		 * @param windowEvent the window message that occurred
+		 */
+		void windowMessageReceived(WindowEventPtr windowEvent) override;
+
+		/**
+		 * Called when the app receives an input message (from a mouse, keyboard etc.)
+		 * @param inputEvent the input event that occurred
+		 */
+		void inputMessageReceived(InputEventPtr inputEvent) override;
+
+		/**
+		 * Called when the app is shutting down after quit() has been invoked
+		 * @return the application exit code, this is returned when the main loop is exited
+		 */
+		virtual int shutdown() override;
+
+	private:
+		/**
+		 * Cached, pre-formatted strings of a single table row
+		 */
+		struct Row
+		{
+			SunsetCalculatorComponentInstance* mCalculator = nullptr;
+			SunsetCalculatorComponentInstance::EState mState = SunsetCalculatorComponentInstance::EState::Unknown;
+			SystemTimeStamp mSunRiseStamp;			///< Sunrise the strings were built for
+			std::string mLocation;					///< Formatted latitude and longitude
+			std::string mSunRise;					///< Formatted sunrise
+			std::string mSunSet;					///< Formatted sunset
+		};
+
+		/**
+		 * Spawns a calculator for every cell of a global grid with the given number of rows and columns
+		 */
+		bool spawnCalculators(int rows, int columns, utility::ErrorState& error);
+
+		/**
+		 * Destroys all spawned calculators
+		 */
+		void destroyCalculators();
+
+		ResourceManager*			mResourceManager = nullptr;		///< Manages all the loaded data
+		RenderService*				mRenderService = nullptr;		///< Render Service that handles render calls
+		SceneService*				mSceneService = nullptr;		///< Manages all the objects in the scene
+		InputService*				mInputService = nullptr;		///< Input service for processing input
+		IMGuiService*				mGuiService = nullptr;			///< Manages GUI related update / draw calls
+		ObjectPtr<RenderWindow>		mRenderWindow;					///< Pointer to the render window
+		ObjectPtr<Scene>			mScene = nullptr;				///< Pointer to the main scene
+
+		std::vector<std::unique_ptr<SunsetCalculatorComponent>> mCalculatorResources;	///< Calculator resource of every grid cell
+		std::vector<std::unique_ptr<Entity>> mEntityResources;							///< Entity resource of every grid cell
+		std::vector<SpawnedEntityInstance> mSpawnedEntities;							///< Spawned entity of every grid cell
+		std::vector<Row> mRows;															///< Cached row strings
+		int mGridRows = 45;								///< Number of latitude rows in the grid
+		int mGridColumns = 90;							///< Number of longitude columns in the grid
+		double mFrameTime = 0.0;						///< Smoothed frame time in milliseconds
+		SunsetSiteGroup mGroup;							///< Keeps track of the number of calculators in daylight
+	};
+}
@@ -8,5 +8,63 @@ source_group("Sunset" FILES ${SUNSET_CPP})
 target_sources(${PROJECT_NAME} PRIVATE ${SUNSET_CPP})
 target_include_directories(${PROJECT_NAME} PRIVATE ${SUNSET_DIR}/include)
 
+# shared memory publication, shm_open lives in librt on older glibc
+if(UNIX AND NOT APPLE)
+    target_link_libraries(${PROJECT_NAME} rt)
+endif()
+
+# bake a sunrise / sunset table for a fixed location into the binary, used by the Baked engine
+# the table is computed by the compiler, which requires raised constexpr evaluation limits
+option(NAPSUNSET_BAKE "Bake a sunrise / sunset table for a fixed location into the module" OFF)
+if(NAPSUNSET_BAKE)
+    set(NAPSUNSET_BAKED_LATITUDE "52.3676" CACHE STRING "Baked latitude in degrees")
+    set(NAPSUNSET_BAKED_LONGITUDE "4.9041" CACHE STRING "Baked longitude in degrees")
+    set(NAPSUNSET_BAKED_FIRST_YEAR "2025" CACHE STRING "First baked year")
+    set(NAPSUNSET_BAKED_YEARS "10" CACHE STRING "Number of baked years")
+    set(BAKED_CPP ${NAP_ROOT}/modules/napsunset/src/sunsetbaked.cpp)
+    set_property(SOURCE ${BAKED_CPP} APPEND PROPERTY COMPILE_DEFINITIONS
+        NAPSUNSET_BAKED_LATITUDE=${NAPSUNSET_BAKED_LATITUDE}
+        NAPSUNSET_BAKED_LONGITUDE=${NAPSUNSET_BAKED_LONGITUDE}
+        NAPSUNSET_BAKED_FIRST_YEAR=${NAPSUNSET_BAKED_FIRST_YEAR}
+        NAPSUNSET_BAKED_YEARS=${NAPSUNSET_BAKED_YEARS})
+    if(MSVC)
+        set_property(SOURCE ${BAKED_CPP} APPEND PROPERTY COMPILE_OPTIONS /constexpr:steps2147483647 /constexpr:loop10000000)
+    elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        set_property(SOURCE ${BAKED_CPP} APPEND PROPERTY COMPILE_OPTIONS -fconstexpr-steps=2147483647)
+    else()
+        set_property(SOURCE ${BAKED_CPP} APPEND PROPERTY COMPILE_OPTIONS -fconstexpr-ops-limit=4294967295 -fconstexpr-loop-limit=10000000)
+    endif()
+endif()
+
 # install sunset license
-install(FILES ${SUNSET_DIR}/LICENSE DESTINATION licenses/sunset)
\ No newline at end of file
+install(FILES ${SUNSET_DIR}/LICENSE DESTINATION licenses/sunset)
+
+# headless bulk sunrise / sunset generator, only depends on the sunset library
+option(NAPSUNSET_BUILD_BULK "Build the sunsetbulk command line tool" OFF)
+if(NAPSUNSET_BUILD_BULK)
+    find_package(Threads REQUIRED)
+    add_executable(sunsetbulk ${NAP_ROOT}/modules/napsunset/tools/sunsetbulk/main.cpp ${SUNSET_CPP})
+    target_include_directories(sunsetbulk PRIVATE ${SUNSET_DIR}/include)
+    target_link_libraries(sunsetbulk Threads::Threads)
+    set_target_properties(sunsetbulk PROPERTIES CXX_STANDARD 17)
+    install(TARGETS sunsetbulk DESTINATION tools/sunsetbulk)
+endif()
+
+# reports cost and accuracy of the sunrise / sunset engines side by side
+option(NAPSUNSET_BUILD_BENCH "Build the sunsetbench engine benchmark" OFF)
+if(NAPSUNSET_BUILD_BENCH)
+    add_executable(sunsetbench ${NAP_ROOT}/modules/napsunset/tools/sunsetbench/main.cpp)
+    target_link_libraries(sunsetbench ${PROJECT_NAME})
+    set_target_properties(sunsetbench PROPERTIES CXX_STANDARD 17)
+endif()
+
+# validates the sunset model against the golden table, fails on drift or exceeding the time budget
+# ctest only finds the test from the top of the build tree when the root project calls enable_testing() as well
+option(NAPSUNSET_BUILD_VALIDATE "Build the sunsetvalidate golden table check" OFF)
+if(NAPSUNSET_BUILD_VALIDATE)
+    enable_testing()
+    add_executable(sunsetvalidate ${NAP_ROOT}/modules/napsunset/tools/sunsetvalidate/main.cpp)
+    target_link_libraries(sunsetvalidate ${PROJECT_NAME})
+    set_target_properties(sunsetvalidate PROPERTIES CXX_STANDARD 17)
+    add_test(NAME sunsetvalidate COMMAND sunsetvalidate)
+endif()
@@ -0,0 +1,95 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetbaked.h"
+#include "sunsetconstexpr.h"
+
+#include <cmath>
+
+namespace nap
+{
+	namespace sunset
+	{
+#ifdef NAPSUNSET_BAKED_LATITUDE
+		static constexpr double bakedLatitude = NAPSUNSET_BAKED_LATITUDE;
+		static constexpr double bakedLongitude = NAPSUNSET_BAKED_LONGITUDE;
+		static constexpr int bakedFirstYear = NAPSUNSET_BAKED_FIRST_YEAR;
+		static constexpr int bakedYears = NAPSUNSET_BAKED_YEARS;
+		static constexpr int bakedCount = cx::bakedDayCount(bakedFirstYear, bakedYears);
+
+		// Evaluated by the compiler, requires raised constexpr limits, see module_extra.cmake
+		static constexpr auto bakedTable = cx::bakeTable<bakedCount>(bakedLatitude, bakedLongitude, bakedFirstYear);
+		static constexpr bool baked = true;
+#else
+		static constexpr double bakedLatitude = 0.0;
+		static constexpr double bakedLongitude = 0.0;
+		static constexpr int bakedFirstYear = 0;
+		static constexpr int bakedYears = 0;
+		static constexpr int bakedCount = 0;
+		static constexpr cx::BakedDay bakedTable[1] = {};
+		static constexpr bool baked = false;
+#endif
+
+		// Positions closer than this to the baked location are looked up, about 1 cm
+		static constexpr double positionEpsilon = 1e-7;
+
+
+		BakedInfo getBakedInfo()
+		{
+			return { baked, bakedLatitude, bakedLongitude, bakedFirstYear, bakedYears };
+		}
+
+
+		BakedEngine::BakedEngine() :
+			mFallback(createEngine(EEngine::NOAA))
+		{ }
+
+
+		void BakedEngine::setDate(int year, int month, int day)
+		{
+			mFallback->setDate(year, month, day);
+			int index = baked ? cx::bakedDayIndex(bakedFirstYear, year, month, day) : -1;
+			mDayIndex = index >= 0 && index < bakedCount ? index : -1;
+		}
+
+
+		void BakedEngine::setPosition(double latitude, double longitude, double timezone)
+		{
+			mFallback->setPosition(latitude, longitude, timezone);
+			mTimezone = timezone;
+			mBaked = baked &&
+				std::abs(latitude - bakedLatitude) < positionEpsilon &&
+				std::abs(longitude - bakedLongitude) < positionEpsilon;
+		}
+
+
+		double BakedEngine::calcCustomSunrise(double zenith) const
+		{
+			// Table is in UTC, the timezone includes daylight saving
+			if (isBaked() && zenith == officialZenith)
+				return static_cast<double>(bakedTable[mDayIndex].mSunrise) + 60.0 * mTimezone;
+			return mFallback->calcCustomSunrise(zenith);
+		}
+
+
+		double BakedEngine::calcCustomSunset(double zenith) const
+		{
+			if (isBaked() && zenith == officialZenith)
+				return static_cast<double>(bakedTable[mDayIndex].mSunset) + 60.0 * mTimezone;
+			return mFallback->calcCustomSunset(zenith);
+		}
+
+
+		void BakedEngine::calcElevationCrossings(const double* elevations, int count, double* outSunrises, double* outSunsets) const
+		{
+			mFallback->calcElevationCrossings(elevations, count, outSunrises, outSunsets);
+		}
+
+
+		void BakedEngine::calcSolarTerms(SolarTerms& outTerms) const
+		{
+			mFallback->calcSolarTerms(outTerms);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "sunsetengine.h"
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Location and range of years of the sunrise / sunset table baked into the binary.
+		 * Configured with the NAPSUNSET_BAKE CMake option.
+		 */
+		struct BakedInfo
+		{
+			bool mAvailable = false;		///< If a table is baked into the binary
+			double mLatitude = 0.0;			///< Baked latitude in degrees
+			double mLongitude = 0.0;		///< Baked longitude in degrees
+			int mFirstYear = 0;				///< First baked year
+			int mYears = 0;					///< Number of baked years
+		};
+
+		/**
+		 * @return location and range of years of the baked table
+		 */
+		BakedInfo NAPAPI getBakedInfo();
+
+
+		/**
+		 * Looks up the official sunrise and sunset in a table computed at compile time.
+		 * Days outside of the baked years, other locations, other zenith angles, elevation crossings
+		 * and solar terms are computed by the NOAA engine, which the table reproduces.
+		 */
+		class NAPAPI BakedEngine : public Engine
+		{
+		public:
+			BakedEngine();
+			void setDate(int year, int month, int day) override;
+			void setPosition(double latitude, double longitude, double timezone) override;
+			double calcCustomSunrise(double zenith) const override;
+			double calcCustomSunset(double zenith) const override;
+			void calcElevationCrossings(const double* elevations, int count, double* outSunrises, double* outSunsets) const override;
+			void calcSolarTerms(SolarTerms& outTerms) const override;
+
+			/**
+			 * @return if sunrise and sunset of the current day and location are looked up
+			 */
+			bool isBaked() const								{ return mBaked && mDayIndex >= 0; }
+
+		private:
+			std::unique_ptr<Engine> mFallback;		///< NOAA engine, used when the table doesn't cover the request
+			double mTimezone = 0.0;
+			int mDayIndex = -1;						///< Index in the table, -1 when the day isn't baked
+			bool mBaked = false;					///< If the location is baked
+		};
+	}
+}
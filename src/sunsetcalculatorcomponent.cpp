@@ -3,12 +3,14 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 
 #include "sunsetcalculatorcomponent.h"
+#include "sunsetservice.h"
 
 #include <entity.h>
 #include <nap/core.h>
 #include <nap/logger.h>
 #include <nap/datetime.h>
-#include <sunset.h>
+#include <algorithm>
+#include <cmath>
 
 RTTI_BEGIN_ENUM(nap::SunsetCalculatorComponentInstance::EState)
 	RTTI_ENUM_VALUE(nap::SunsetCalculatorComponentInstance::EState::Down,		"Down"),
@@ -16,12 +18,25 @@ RTTI_BEGIN_ENUM(nap::SunsetCalculatorComponentInstance::EState)
 	RTTI_ENUM_VALUE(nap::SunsetCalculatorComponentInstance::EState::Unknown,	"Unknown")
 RTTI_END_ENUM
 
+RTTI_BEGIN_ENUM(nap::sunset::EEngine)
+	RTTI_ENUM_VALUE(nap::sunset::EEngine::NOAA,		"NOAA"),
+	RTTI_ENUM_VALUE(nap::sunset::EEngine::Fast,		"Fast"),
+	RTTI_ENUM_VALUE(nap::sunset::EEngine::Precise,	"Precise"),
+	RTTI_ENUM_VALUE(nap::sunset::EEngine::Baked,	"Baked")
+RTTI_END_ENUM
+
 RTTI_BEGIN_CLASS(nap::SunsetCalculatorComponent)
 	RTTI_PROPERTY("Latitude", &nap::SunsetCalculatorComponent::mLatitude, nap::rtti::EPropertyMetaData::Default, "Latitude of the location we want to know the sunrise and sundown of")
 	RTTI_PROPERTY("Longitude", &nap::SunsetCalculatorComponent::mLongitude, nap::rtti::EPropertyMetaData::Default, "Longitude of the location we want to know the sunrise and sundown of")
-	RTTI_PROPERTY("TimeZone", &nap::SunsetCalculatorComponent::mTimezone, nap::rtti::EPropertyMetaData::Default, "Timezone at Longitude excluding daylight saving")
+	RTTI_PROPERTY("TimeZone", &nap::SunsetCalculatorComponent::mTimezone, nap::rtti::EPropertyMetaData::Default, "Timezone in hours at Longitude excluding daylight saving, fractional for half and quarter hour zones")
 	RTTI_PROPERTY("SunriseOffset", &nap::SunsetCalculatorComponent::mSunriseOffset, nap::rtti::EPropertyMetaData::Default, "Sunrise offset in minutes")
 	RTTI_PROPERTY("SunsetOffset", &nap::SunsetCalculatorComponent::mSunsetOffset, nap::rtti::EPropertyMetaData::Default, "Sunrise offset in minutes")
+	RTTI_PROPERTY("ElevationThresholds", &nap::SunsetCalculatorComponent::mElevationThresholds, nap::rtti::EPropertyMetaData::Default, "Sun elevations in degrees to receive crossing events for")
+	RTTI_PROPERTY("PositionTolerance", &nap::SunsetCalculatorComponent::mPositionTolerance, nap::rtti::EPropertyMetaData::Default, "Max estimated sunrise / sunset shift in seconds before events are recomputed for a moving observer")
+	RTTI_PROPERTY("Engine", &nap::SunsetCalculatorComponent::mEngine, nap::rtti::EPropertyMetaData::Default, "Sunrise / sunset engine: NOAA (default), Fast (approximate), Precise (SPA) or Baked (compile time table)")
+	RTTI_PROPERTY("Horizon", &nap::SunsetCalculatorComponent::mHorizon, nap::rtti::EPropertyMetaData::Default, "Optional horizon profile, sunrise and sunset are computed over the profile instead of the flat horizon")
+	RTTI_PROPERTY("TimeZoneMap", &nap::SunsetCalculatorComponent::mTimeZoneMap, nap::rtti::EPropertyMetaData::Default, "Optional timezone map, the timezone is looked up from latitude and longitude instead of using 'TimeZone'")
+	RTTI_PROPERTY("EventCacheSize", &nap::SunsetCalculatorComponent::mEventCacheSize, nap::rtti::EPropertyMetaData::Default, "Max number of days cached by arbitrary date queries")
 RTTI_END_CLASS
 
 RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::SunsetCalculatorComponentInstance)
@@ -31,25 +46,140 @@ RTTI_END_CLASS
 
 namespace nap
 {   
+	// Ranges with more days are computed in the background
+	static constexpr int asyncRangeDays = 31;
+
+	// Max sensitivity of sunrise / sunset to latitude in seconds per degree, used near the polar circles
+	static constexpr double maxLatitudeSensitivity = 3600.0;
+
+	/**
+	 * Estimates how much sunrise and sunset shift when the latitude changes, in seconds per degree.
+	 * Derivative of the sunrise hour angle: cos(H) = (cos(z) - sin(lat) sin(dec)) / (cos(lat) cos(dec)),
+	 * using the half day length for H and an approximate declination for the day of the year.
+	 * Accurate to a few seconds per degree, capped near the polar circles where the derivative diverges.
+	 * The day of the year is zero based.
+	 */
+	static double latitudeSensitivity(double latitude, int dayOfYear, double sunrise, double sunset)
+	{
+		if (!std::isfinite(sunrise) || !std::isfinite(sunset))
+			return maxLatitudeSensitivity;
+
+		// Spencer's declination series, accurate to a few hundredths of a degree
+		double g = math::radians(360.0 / 365.0 * dayOfYear);
+		double declination = 0.006918 - 0.399912 * std::cos(g) + 0.070257 * std::sin(g) - 0.006758 * std::cos(2.0 * g) +
+			0.000907 * std::sin(2.0 * g) - 0.002697 * std::cos(3.0 * g) + 0.00148 * std::sin(3.0 * g);
+		double phi = math::radians(latitude);
+		double hour_angle = math::radians((sunset - sunrise) / 8.0);
+		double sin_h = std::sin(hour_angle);
+		double dcos = (std::cos(math::radians(sunset::Engine::officialZenith)) * std::sin(phi) - std::sin(declination)) /
+			(std::cos(phi) * std::cos(phi) * std::cos(declination));
+
+		// One degree of hour angle is 4 minutes
+		double sensitivity = 240.0 * std::abs(dcos) / std::max(sin_h, 1e-6);
+		return std::min(sensitivity, maxLatitudeSensitivity);
+	}
+
+
+	// Duration in minutes
+	template<typename D>
+	static double toMinutes(const D& duration)
+	{
+		return std::chrono::duration<double, std::ratio<60>>(duration).count();
+	}
+
+
+	/**
+	 * Converts sunrise and sunset in minutes past midnight to timestamps.
+	 * Without sunrise the sun is up from midnight, without sunset it's up until the next midnight: infinite times
+	 * are reported when the sun stays clear of a horizon mask, NaN on a polar day or when the sun doesn't rise at all.
+	 * When the sun doesn't rise both are midnight, the sun is down all day.
+	 */
+	static void toTimeStamps(const sunset::Events& events, bool polarDay, const SystemTimeStamp& midnight, const SystemTimeStamp& nextMidnight,
+		SystemTimeStamp& outSunrise, SystemTimeStamp& outSunset)
+	{
+		static constexpr double mms = 60.0 * 1000.0;
+		if ((std::isnan(events.mSunrise) || std::isnan(events.mSunset)) && !polarDay)
+		{
+			outSunrise = outSunset = midnight;
+			return;
+		}
+		outSunrise = std::isfinite(events.mSunrise) ? midnight + Milliseconds(static_cast<int64>(events.mSunrise * mms)) : midnight;
+		outSunset = std::isfinite(events.mSunset) ? midnight + Milliseconds(static_cast<int64>(events.mSunset * mms)) : nextMidnight;
+	}
+
+
+	/**
+	 * Computes sunrise and sunset of a day in minutes past local midnight, including offsets.
+	 * Adds 1 hour to the timezone if daylight saving is active at midnight.
+	 * When a horizon mask is given the sun rises and sets over the mask instead of the flat horizon.
+	 */
+	static sunset::Events computeDayEvents(sunset::Engine& engine, const sunset::Location& location, const sunset::HorizonMask* horizon,
+		double sunriseOffset, double sunsetOffset, const sunset::Day& day)
+	{
+		auto null_time = createTimestamp(day.mYear, day.mMonth, day.mDay, 0, 0, 0);
+		bool dst = DateTime(null_time, DateTime::ConversionMode::Local).isDaylightSaving();
+		engine.setDate(day.mYear, day.mMonth, day.mDay);
+		engine.setPosition(location.mLatitude, location.mLongitude, dst ? location.mTimezone + 1.0 : location.mTimezone);
+
+		sunset::Events events;
+		if (horizon != nullptr)
+		{
+			engine.calcHorizonCrossings(*horizon, events.mSunrise, events.mSunset);
+		}
+		else
+		{
+			events.mSunrise = engine.calcSunrise();
+			events.mSunset = engine.calcSunset();
+		}
+		events.mSunrise += sunriseOffset;
+		events.mSunset += sunsetOffset;
+		return events;
+	}
+
+
 	SunsetCalculatorComponentInstance::SunsetCalculatorComponentInstance(EntityInstance& entity, Component& resource) :
-		ComponentInstance(entity, resource),
-		mModel(std::make_unique<SunSet>())
+		ComponentInstance(entity, resource)
 	{ }
 
 
-	// this is needed for the PIMPL (Pointer To Implementation) to work with the unique_ptr to Sunset in the header
-	SunsetCalculatorComponentInstance::~SunsetCalculatorComponentInstance() { }
+	SunsetCalculatorComponentInstance::~SunsetCalculatorComponentInstance()
+	{
+		if (mService != nullptr)
+			mService->removeCalculator(mServiceID);
+	}
 
 
 	bool SunsetCalculatorComponentInstance::init(utility::ErrorState& errorState)
     {
+		// Register with service, schedules transitions when the timer thread is enabled
+		mService = getEntityInstance()->getCore()->getService<SunsetService>();
+		if (!errorState.check(mService != nullptr, "%s: unable to find sunset service", mID.c_str()))
+			return false;
+		mServiceID = mService->registerCalculator(*this);
+
 		// Set position
 		auto* resource = getComponent<nap::SunsetCalculatorComponent>();
-		mTimezone = resource->mTimezone;
 		mLongitude = resource->mLongitude;
 		mLatitude = resource->mLatitude;
+		mTimeZoneMap = resource->mTimeZoneMap.get();
+		mTimezone = mTimeZoneMap != nullptr ? mTimeZoneMap->getTimezone(mLatitude, mLongitude) : resource->mTimezone;
 		mSunriseOffset = resource->mSunriseOffset;
 		mSunsetOffset = resource->mSunsetOffset;
+		mPositionTolerance = resource->mPositionTolerance;
+		if (resource->mHorizon != nullptr)
+			mHorizon = std::make_shared<sunset::HorizonMask>(resource->mHorizon->getMask());
+		mEngineType = resource->mEngine;
+		mModel = sunset::createEngine(mEngineType);
+		if (!errorState.check(resource->mEventCacheSize > 0, "%s: invalid event cache size", mID.c_str()))
+			return false;
+		mEventCache = std::make_shared<sunset::EventCache>(static_cast<size_t>(resource->mEventCacheSize));
+
+		// Elevation thresholds, sorted from low to high
+		std::vector<double> elevations = resource->mElevationThresholds;
+		std::sort(elevations.begin(), elevations.end());
+		mThresholds.resize(elevations.size());
+		for (size_t i = 0; i < elevations.size(); i++)
+			mThresholds[i].mElevation = elevations[i];
 
 		// Compute
 		update(0.0);
@@ -65,41 +195,346 @@ namespace nap
 		auto date_time = getCurrentDateTime();
 
 		// If day changed, update sunset / sunrise information
+		bool computed = false;
 		if (mDay != date_time.getDay())
 		{
-			// Get null (midnight) for current date/time
-			auto null_time = createTimestamp(date_time.getYear(), static_cast<int>(date_time.getMonth()), date_time.getDayInTheMonth(), 0, 0, 0);
-
-			// Compute sunset / sunrise for current day -> add 1 hour if daylight saving is still active
-			bool dst = DateTime(null_time, DateTime::ConversionMode::Local).isDaylightSaving();
-			mModel->setCurrentDate(date_time.getYear(), static_cast<int>(date_time.getMonth()), date_time.getDayInTheMonth());
-			mModel->setPosition(mLatitude, mLongitude, dst ? mTimezone + 1 : mTimezone);
-
-			// Compute sunrise
-			static constexpr double mms = 60.0 * 1000.0;
-			double sunrise = mModel->calcSunrise() + mSunriseOffset;
-			mSunRiseStamp = null_time + Milliseconds(static_cast<int64>(sunrise * mms));
-			mSunRise = DateTime(mSunRiseStamp, DateTime::ConversionMode::Local);
-
-			// Compute sunset
-			double sunset = mModel->calcSunset() + mSunsetOffset;
-			mSunSetStamp = null_time + Milliseconds(static_cast<int64>(sunset * mms));
-			mSunset = DateTime(mSunSetStamp, DateTime::ConversionMode::Local);
-
-			// Store computed day
-			mDay = date_time.getDay();
+			// Spread day rollover over multiple frames when the service has a budget, initial day is always computed
+			computed = !mService->hasRolloverBudget() || mDay == EDay::Unknown;
+			if (computed)
+				computeDay(date_time);
+			else
+				estimateDay(date_time);
+		}
+
+		// Poll for transitions, the timer thread only takes over once the initial state is resolved.
+		// Recomputed events replace the scheduled transitions from now on, catch up on the ones that passed.
+		if (!mService->hasTimerThread() || mState == EState::Unknown || computed)
+			evaluate(date_time.getTimeStamp());
+	}
+
+
+	void SunsetCalculatorComponentInstance::computeDay(const DateTime& date_time)
+	{
+		// Get null (midnight) for current date/time
+		auto null_time = createTimestamp(date_time.getYear(), static_cast<int>(date_time.getMonth()), date_time.getDayInTheMonth(), 0, 0, 0);
+
+		// Compute sunset / sunrise for current day
+		sunset::Day day = { date_time.getYear(), static_cast<int>(date_time.getMonth()), date_time.getDayInTheMonth() };
+		sunset::Location location = { mLatitude, mLongitude, mTimezone };
+		auto events = computeDayEvents(*mModel, location, mHorizon.get(), mSunriseOffset, mSunsetOffset, day);
+
+		// Compute elevation thresholds and solar terms, the model is still set to the current day
+		computeThresholds(null_time);
+		mModel->calcSolarTerms(mTerms);
+		mMidnight = null_time;
+
+		// Get null (midnight) of the next day
+		DateTime next_date_time(null_time + Hours(36), DateTime::ConversionMode::Local);
+		sunset::Day next_day = { next_date_time.getYear(), static_cast<int>(next_date_time.getMonth()), next_date_time.getDayInTheMonth() };
+		auto next_null_time = createTimestamp(next_day.mYear, next_day.mMonth, next_day.mDay, 0, 0, 0);
+		mNextMidnight = next_null_time;
+
+		// Compute sunrise and sunset, the sun can stay up or down all day near the poles or behind a horizon mask.
+		// Without a mask a day without sunrise or sunset is a polar day or night, with a mask the sun doesn't clear it.
+		double sunrise = events.mSunrise;
+		double sunset = events.mSunset;
+		bool polar_day = mHorizon == nullptr && sunset::isPolarDay(mLatitude, mTerms.mDeclination[1]);
+		toTimeStamps(events, polar_day, null_time, next_null_time, mSunRiseStamp, mSunSetStamp);
+		mHasSunRise = std::isfinite(sunrise);
+		mHasSunSet = std::isfinite(sunset);
+		mSunRise = DateTime(mSunRiseStamp, DateTime::ConversionMode::Local);
+		mSunset = DateTime(mSunSetStamp, DateTime::ConversionMode::Local);
+
+		// Compute sunrise of the next day, the next transition after sunset.
+		// When the sun doesn't rise the next day, there's no transition before the day after.
+		auto next_events = computeDayEvents(*mModel, location, mHorizon.get(), mSunriseOffset, mSunsetOffset, next_day);
+		bool next_polar_day = mHorizon == nullptr && sunset::isPolarDay(mLatitude, 2.0 * mTerms.mDeclination[2] - mTerms.mDeclination[1]);
+		SystemTimeStamp next_sunset;
+		toTimeStamps(next_events, next_polar_day, next_null_time, next_null_time + Hours(24), mNextSunRiseStamp, next_sunset);
+		if (mNextSunRiseStamp == next_sunset)
+			mNextSunRiseStamp = next_sunset + Hours(24);
+
+		// Store computed day and position
+		mDay = date_time.getDay();
+		mProvisional = false;
+		mEventLatitude = mLatitude;
+		mEventLongitude = mLongitude;
+		mLatitudeSensitivity = latitudeSensitivity(mLatitude, date_time.getDayInTheYear(),
+			sunrise - mSunriseOffset, sunset - mSunsetOffset);
+
+		mService->logEvent(sunset::ELogEvent::DayComputed, mServiceID, *this, date_time.getTimeStamp(), sunrise, sunset);
+
+		// Let the timer thread fire the transitions of the new day
+		if (mService->hasTimerThread())
+			scheduleTransitions(date_time.getTimeStamp());
+
+		// Publish events of the new day
+		mService->publish(mServiceID, *this);
+	}
+
+
+	void SunsetCalculatorComponentInstance::estimateDay(const DateTime& date_time)
+	{
+		// Events shift by minutes from one day to the next: the previous day moved by 24 hours is a close estimate
+		mSunRiseStamp += Hours(24);
+		mSunRise = DateTime(mSunRiseStamp, DateTime::ConversionMode::Local);
+		mSunSetStamp += Hours(24);
+		mSunset = DateTime(mSunSetStamp, DateTime::ConversionMode::Local);
+		mNextSunRiseStamp += Hours(24);
+		mMidnight += Hours(24);
+		mNextMidnight += Hours(24);
+		for (auto& threshold : mThresholds)
+		{
+			threshold.mRiseStamp += Hours(24);
+			threshold.mSetStamp += Hours(24);
 		}
 
+		// Exact values are computed by the service, soonest transition first
+		mDay = date_time.getDay();
+		mProvisional = true;
+		mService->requestRollover(mServiceID, getNextTransitionTimeStamp());
+		mService->logEvent(sunset::ELogEvent::DayEstimated, mServiceID, *this, date_time.getTimeStamp(),
+			toMinutes(mSunRiseStamp - mMidnight), toMinutes(mSunSetStamp - mMidnight));
+	}
+
+
+	void SunsetCalculatorComponentInstance::getSunPosition(const SystemTimeStamp& time, double& outElevation, double& outAzimuth) const
+	{
+		double minutes = toMinutes(time - mMidnight);
+		sunset::calcSolarPosition(mTerms, minutes, outElevation, outAzimuth);
+	}
+
+
+	const SystemTimeStamp& SunsetCalculatorComponentInstance::getNextTransitionTimeStamp() const
+	{
+		if (mState == EState::Up)
+			return mSunSetStamp;
+		return mEvaluated < mSunRiseStamp ? mSunRiseStamp : mNextSunRiseStamp;
+	}
+
+
+	SystemTimeStamp SunsetCalculatorComponentInstance::getNextEventTimeStamp() const
+	{
+		// Unresolved state or moved observer, recomputed on next update
+		if (mState == EState::Unknown || mDay == EDay::Unknown)
+			return mEvaluated;
+
+		// Day rollover, the next transition is usually sooner
+		SystemTimeStamp next = std::min(getNextTransitionTimeStamp(), mNextMidnight);
+		for (const auto& threshold : mThresholds)
+		{
+			if (threshold.mAlwaysAbove || threshold.mAlwaysBelow)
+				continue;
+			if (threshold.mRiseStamp > mEvaluated)
+				next = std::min(next, threshold.mRiseStamp);
+			if (threshold.mSetStamp > mEvaluated)
+				next = std::min(next, threshold.mSetStamp);
+		}
+		return next;
+	}
+
+
+	void SunsetCalculatorComponentInstance::setPosition(double latitude, double longitude)
+	{
+		mLatitude = latitude;
+		mLongitude = longitude;
+
+		// Sunrise and sunset shift 4 minutes per degree of longitude, latitude depends on date and location
+		double shift = 240.0 * std::abs(mLongitude - mEventLongitude) +
+			mLatitudeSensitivity * std::abs(mLatitude - mEventLatitude);
+
+		// Recompute on next update, the observer might have entered another timezone
+		if (shift > mPositionTolerance)
+		{
+			if (mTimeZoneMap != nullptr)
+				mTimezone = mTimeZoneMap->getTimezone(mLatitude, mLongitude);
+			mDay = EDay::Unknown;
+			mEventCache->clear();
+		}
+	}
+
+
+	sunset::Events SunsetCalculatorComponentInstance::getEvents(const sunset::Day& day)
+	{
+		int day_number = sunset::toDayNumber(day);
+		sunset::Events events;
+		if (mEventCache->find(day_number, events))
+			return events;
+
+		int generation = mEventCache->getGeneration();
+		sunset::Location location = { mLatitude, mLongitude, mTimezone };
+		events = computeDayEvents(*mModel, location, mHorizon.get(), mSunriseOffset, mSunsetOffset, day);
+		mEventCache->insert(day_number, events, generation);
+		return events;
+	}
+
+
+	std::future<std::vector<sunset::Events>> SunsetCalculatorComponentInstance::getEventsRange(const sunset::Day& from, const sunset::Day& to)
+	{
+		// Everything the computation needs is copied, the component might be destroyed before it completes
+		int first = sunset::toDayNumber(from);
+		int last = sunset::toDayNumber(to);
+		auto compute = [cache = mEventCache, generation = mEventCache->getGeneration(), engine_type = mEngineType,
+			location = sunset::Location{ mLatitude, mLongitude, mTimezone },
+			horizon = mHorizon, sunrise_offset = mSunriseOffset, sunset_offset = mSunsetOffset, first, last]()
+		{
+			auto engine = sunset::createEngine(engine_type);
+			std::vector<sunset::Events> range;
+			range.reserve(static_cast<size_t>(std::max(last - first + 1, 0)));
+			for (int day_number = first; day_number <= last; day_number++)
+			{
+				sunset::Events events;
+				if (!cache->find(day_number, events))
+				{
+					events = computeDayEvents(*engine, location, horizon.get(), sunrise_offset, sunset_offset, sunset::fromDayNumber(day_number));
+					cache->insert(day_number, events, generation);
+				}
+				range.emplace_back(events);
+			}
+			return range;
+		};
+
+		if (last - first + 1 > asyncRangeDays)
+			return std::async(std::launch::async, std::move(compute));
+
+		std::promise<std::vector<sunset::Events>> result;
+		result.set_value(compute());
+		return result.get_future();
+	}
+
+
+	void SunsetCalculatorComponentInstance::evaluate(const SystemTimeStamp& time)
+	{
+		if (time < mEvaluated)
+			return;
+		mEvaluated = time;
+
+		// Estimated events never fire a transition, the exact time might be on the other side of now:
+		// compute the exact events first, which only happens for calculators with a transition while estimated
+		if (mProvisional && isChanging(time))
+			computeDay(DateTime(time, DateTime::ConversionMode::Local));
+
 		// Check if we need to notify listeners
-		const auto& current = date_time.getTimeStamp();
-		auto current_state = current > mSunRiseStamp && current < mSunSetStamp ?
-			EState::Up : EState::Down;
+		auto current_state = getStateAt(time);
 
 		// Notify listeners
 		if (current_state != mState)
 		{
+			mStateStamp = mState == EState::Unknown ? time :
+				current_state == EState::Up ? mSunRiseStamp : mSunSetStamp;
 			mState = current_state;
+			mService->logEvent(sunset::ELogEvent::Transition, mServiceID, *this, mStateStamp,
+				toMinutes(mSunRiseStamp - mMidnight), toMinutes(mSunSetStamp - mMidnight));
 			mSunStateChanged(mState);
+			mService->publish(mServiceID, *this);
+			if (mState == EState::Up)
+				mSunUp();
+			else
+				mSunDown();
+		}
+
+		// Notify elevation threshold listeners
+		updateThresholds(time);
+	}
+
+
+	SunsetCalculatorComponentInstance::EState SunsetCalculatorComponentInstance::getStateAt(const SystemTimeStamp& time) const
+	{
+		return time >= mSunRiseStamp && time < mSunSetStamp ? EState::Up : EState::Down;
+	}
+
+
+	bool SunsetCalculatorComponentInstance::isAbove(const Threshold& threshold, const SystemTimeStamp& time)
+	{
+		return threshold.mAlwaysAbove || (!threshold.mAlwaysBelow && time >= threshold.mRiseStamp && time < threshold.mSetStamp);
+	}
+
+
+	bool SunsetCalculatorComponentInstance::isChanging(const SystemTimeStamp& time) const
+	{
+		if (getStateAt(time) != mState)
+			return true;
+
+		for (const auto& threshold : mThresholds)
+		{
+			if (threshold.mAbove != -1 && threshold.mAbove != (isAbove(threshold, time) ? 1 : 0))
+				return true;
+		}
+		return false;
+	}
+
+
+	void SunsetCalculatorComponentInstance::scheduleTransitions(const SystemTimeStamp& current)
+	{
+		std::vector<SystemTimeStamp> times;
+		auto add = [&times, &current](const SystemTimeStamp& time)
+		{
+			if (time > current)
+				times.emplace_back(time);
+		};
+
+		// Midnight isn't a transition when the sun stays up or down
+		if (mHasSunRise)
+			add(mSunRiseStamp);
+		if (mHasSunSet)
+			add(mSunSetStamp);
+		for (const auto& threshold : mThresholds)
+		{
+			if (threshold.mAlwaysAbove || threshold.mAlwaysBelow)
+				continue;
+			add(threshold.mRiseStamp);
+			add(threshold.mSetStamp);
+		}
+
+		// Replaces the transitions scheduled for the previous day or position
+		mService->schedule(mServiceID, times);
+	}
+
+
+	void SunsetCalculatorComponentInstance::computeThresholds(const SystemTimeStamp& midnight)
+	{
+		if (mThresholds.empty())
+			return;
+
+		// Compute all crossings in one pass
+		std::vector<double> elevations(mThresholds.size());
+		for (size_t i = 0; i < mThresholds.size(); i++)
+			elevations[i] = mThresholds[i].mElevation;
+
+		std::vector<double> rises(mThresholds.size()), sets(mThresholds.size());
+		mModel->calcElevationCrossings(elevations.data(), static_cast<int>(elevations.size()), rises.data(), sets.data());
+
+		// Convert to timestamps, infinite when the sun stays above, NaN when the elevation isn't reached
+		static constexpr double mms = 60.0 * 1000.0;
+		for (size_t i = 0; i < mThresholds.size(); i++)
+		{
+			auto& threshold = mThresholds[i];
+			threshold.mAlwaysAbove = std::isinf(rises[i]);
+			threshold.mAlwaysBelow = std::isnan(rises[i]) || std::isnan(sets[i]);
+			if (threshold.mAlwaysAbove || threshold.mAlwaysBelow)
+				continue;
+
+			threshold.mRiseStamp = midnight + Milliseconds(static_cast<int64>(rises[i] * mms));
+			threshold.mSetStamp = midnight + Milliseconds(static_cast<int64>(sets[i] * mms));
+		}
+	}
+
+
+	void SunsetCalculatorComponentInstance::updateThresholds(const SystemTimeStamp& current)
+	{
+		for (auto& threshold : mThresholds)
+		{
+			// Only notify on actual crossings, not when the initial state is resolved
+			bool above = isAbove(threshold, current);
+			int8 state = above ? 1 : 0;
+			bool crossed = threshold.mAbove != -1 && threshold.mAbove != state;
+			threshold.mAbove = state;
+			if (crossed)
+			{
+				mService->logEvent(sunset::ELogEvent::Elevation, mServiceID, *this, above ? threshold.mRiseStamp : threshold.mSetStamp,
+					threshold.mElevation, above ? 1.0 : 0.0);
+				mElevationCrossed(threshold.mElevation, above);
+			}
 		}
 	}
 }
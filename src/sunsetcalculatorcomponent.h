@@ -10,12 +10,17 @@
 #include <nap/signalslot.h>
 #include <mathutils.h>
 
-// Forward declare thirdparty-sunset
-class SunSet;
+#include "sunsetengine.h"
+#include "sunsetevents.h"
+#include "sunsethorizonprofile.h"
+#include "sunsettimezonemap.h"
+
+#include <future>
 
 namespace nap
 {
 	class SunsetCalculatorComponentInstance;
+	class SunsetService;
 
 	/**
 	 * Calculates local sunset and sunrise for a given lat and longitude.
@@ -29,9 +34,15 @@ namespace nap
 		public:
 			double mLatitude = 0;					///< Property: 'Latitude' set to use 0	(Greenwich)	->(nul island)
 			double mLongitude = 0;					///< Property: 'Longitude' set to use 0(equator)	->(nul island)
-			int mTimezone = 1;						///< Property: 'Timezone' timezone, excluding daylight savings
+			double mTimezone = 1.0;					///< Property: 'TimeZone' timezone in hours, excluding daylight savings, fractional for half and quarter hour zones
     		double mSunriseOffset = 0.0;			///< Property: 'SunriseOffset' sunrise offset in minutes
     		double mSunsetOffset = 0.0;				///< Property: 'SunsetOffset' sunset offset in minutes
+			std::vector<double> mElevationThresholds;	///< Property: 'ElevationThresholds' sun elevations in degrees to receive crossing events for
+			double mPositionTolerance = 10.0;		///< Property: 'PositionTolerance' max estimated sunrise / sunset shift in seconds before events are recomputed for a moving observer
+			sunset::EEngine mEngine = sunset::EEngine::NOAA;	///< Property: 'Engine' sunrise / sunset engine, trades cost for accuracy
+			ResourcePtr<HorizonProfile> mHorizon;	///< Property: 'Horizon' optional horizon profile, sunrise and sunset are computed over the profile instead of the flat horizon
+			ResourcePtr<TimeZoneMap> mTimeZoneMap;	///< Property: 'TimeZoneMap' optional timezone map, the timezone is looked up from latitude and longitude instead of using 'TimeZone'
+			int mEventCacheSize = 366;				///< Property: 'EventCacheSize' max number of days cached by getEvents() and getEventsRange()
     };
 
 
@@ -41,9 +52,13 @@ namespace nap
 	 *
 	 * Note that this component uses the systems local time to check if the sun is up or down,
 	 * not the time deducted from the given lon and latitude -> which it cannot do.
+	 *
+	 * Transitions are detected on update unless the nap::SunsetService timer thread is enabled,
+	 * in which case they are fired at their exact timestamp. Use getStateTimeStamp() to compensate for delivery latency.
 	 */
 	class NAPAPI SunsetCalculatorComponentInstance : public ComponentInstance
 	{
+		friend class SunsetService;
 
 		RTTI_ENABLE(ComponentInstance)
 	public:
@@ -80,6 +95,28 @@ namespace nap
 		 */
 		EState getState() const							{ return mState; }
 
+		/**
+		 * Returns the exact time the current state started: the sunrise or sunset timestamp.
+		 * When the initial state is resolved this is the time of resolution.
+		 * @return time the current state started
+		 */
+		const SystemTimeStamp& getStateTimeStamp() const	{ return mStateStamp; }
+
+		/**
+		 * Returns the time of the next sunrise or sunset: sunset when the sun is up,
+		 * today's or tomorrow's sunrise when the sun is down.
+		 * @return time of the next transition
+		 */
+		const SystemTimeStamp& getNextTransitionTimeStamp() const;
+
+		/**
+		 * Returns the time of the next event that requires an update: the next sunrise or sunset,
+		 * elevation threshold crossing or local midnight, after which the events of the new day are computed.
+		 * Returns the last evaluated time when the calculator is due immediately, for example after it moved.
+		 * @return time of the next event
+		 */
+		SystemTimeStamp getNextEventTimeStamp() const;
+
 		/**
 		 * @return local sunset time
 		 */
@@ -90,6 +127,34 @@ namespace nap
 		 */
 		const DateTime& getSunRise() const				{ return mSunRise; }
 
+		/**
+		 * Returns sunrise and sunset of any day at the current position, including offsets and daylight saving.
+		 * Computed days are kept in a bounded least recently used cache, which is cleared when the observer moves.
+		 * @param day the day to get the events for
+		 * @return sunrise and sunset in minutes past local midnight, NaN when the sun doesn't rise or set
+		 */
+		sunset::Events getEvents(const sunset::Day& day);
+
+		/**
+		 * Returns sunrise and sunset of every day in the range at the current position, including offsets and daylight saving.
+		 * Ranges longer than a month are computed in the background, the future of shorter ranges is ready immediately.
+		 * @param from first day of the range
+		 * @param to last day of the range, inclusive
+		 * @return events of every day in the range, in minutes past local midnight
+		 */
+		std::future<std::vector<sunset::Events>> getEventsRange(const sunset::Day& from, const sunset::Day& to);
+
+		/**
+		 * Moves the observer, call as often as every frame.
+		 * Events are recomputed on the next update only when the move is estimated to shift sunrise or sunset
+		 * by more than 'PositionTolerance' seconds. The estimate is analytic: 4 minutes per degree of longitude
+		 * and the derivative of the sunrise hour angle for latitude. With a 'TimeZoneMap' the timezone is looked up again
+		 * when the events are recomputed, otherwise it is not changed.
+		 * @param latitude new latitude in degrees
+		 * @param longitude new longitude in degrees
+		 */
+		void setPosition(double latitude, double longitude);
+
 		/**
 		 * @return latitude
 		 */
@@ -100,11 +165,51 @@ namespace nap
 		 */
 		double getLongitude() const						{ return mLongitude; }
 
+		/**
+		 * @return timezone in hours excluding daylight saving, looked up from the position when a timezone map is assigned
+		 */
+		double getTimezone() const						{ return mTimezone; }
+
+		/**
+		 * @return if the events of the current day are estimated, see SunsetServiceConfiguration::mRolloverBudget
+		 */
+		bool isProvisional() const						{ return mProvisional; }
+
 		/**
 		 * @return bool `true` if the sun is up (daytime), `false` if down (nighttime).
 		 */
 		bool isUp() const								{ return mState == EState::Up; }
 
+		/**
+		 * @return number of elevation thresholds, sorted from low to high
+		 */
+		int getElevationCount() const					{ return static_cast<int>(mThresholds.size()); }
+
+		/**
+		 * @param index elevation threshold index, sorted from low to high
+		 * @return elevation threshold in degrees
+		 */
+		double getElevation(int index) const			{ return mThresholds[index].mElevation; }
+
+		/**
+		 * @param index elevation threshold index, sorted from low to high
+		 * @return if the sun is currently above the elevation threshold
+		 */
+		bool isAboveElevation(int index) const			{ return mThresholds[index].mAbove == 1; }
+
+		/**
+		 * Computes the geometric position of the sun, without refraction, from the solar terms of the current day.
+		 * @param time the time to compute the position for, preferably on the current day
+		 * @param outElevation receives the sun elevation in degrees
+		 * @param outAzimuth receives the sun azimuth in degrees, 0 = north, 90 = east
+		 */
+		void getSunPosition(const SystemTimeStamp& time, double& outElevation, double& outAzimuth) const;
+
+		/**
+		 * @return solar terms of the current day, including location, see getSunPosition()
+		 */
+		const sunset::SolarTerms& getSolarTerms() const	{ return mTerms; }
+
 		/**
 		 * Listen to this signal to get notified on sunset / sunrise
 		 */
@@ -120,21 +225,108 @@ namespace nap
 		 */
 		Signal<> mSunDown;
 
+		/**
+		 * Listen to this signal to get notified when the sun crosses one of the elevation thresholds.
+		 * Receives the elevation in degrees and `true` when rising through it, `false` when setting.
+		 */
+		Signal<double, bool> mElevationCrossed;
+
 	private:
+		/**
+		 * Rise and set time of a single elevation threshold
+		 */
+		struct Threshold
+		{
+			double mElevation = 0.0;					///< Elevation in degrees
+			SystemTimeStamp mRiseStamp;					///< Time the sun rises through the elevation
+			SystemTimeStamp mSetStamp;					///< Time the sun sets through the elevation
+			bool mAlwaysAbove = false;					///< If the sun stays above the elevation all day
+			bool mAlwaysBelow = false;					///< If the sun never reaches the elevation
+			int8 mAbove = -1;							///< If the sun is currently above the elevation, -1 when unknown
+		};
+
+		/**
+		 * Computes sunrise, sunset and elevation thresholds of the given day
+		 */
+		void computeDay(const DateTime& dateTime);
+
+		/**
+		 * Estimates the events of the given day from the previous day and requests the service to compute them
+		 */
+		void estimateDay(const DateTime& dateTime);
+
+		/**
+		 * Updates the sun state and elevation thresholds for the given time, notifies listeners on change.
+		 * Times before the last evaluated time are ignored. Estimated events are computed before they change the state.
+		 */
+		void evaluate(const SystemTimeStamp& time);
+
+		/**
+		 * @return sun state at the given time according to the current events
+		 */
+		EState getStateAt(const SystemTimeStamp& time) const;
+
+		/**
+		 * @return if the sun is above the elevation threshold at the given time
+		 */
+		static bool isAbove(const Threshold& threshold, const SystemTimeStamp& time);
+
+		/**
+		 * @return if the sun state or an elevation threshold changes at the given time
+		 */
+		bool isChanging(const SystemTimeStamp& time) const;
+
+		/**
+		 * Schedules all transitions of the current day after the given time on the service timer thread,
+		 * replacing the transitions scheduled before
+		 */
+		void scheduleTransitions(const SystemTimeStamp& current);
+
+		/**
+		 * Computes rise and set times of all elevation thresholds for the given day
+		 */
+		void computeThresholds(const SystemTimeStamp& midnight);
+
+		/**
+		 * Notifies listeners of elevation thresholds crossed since last update
+		 */
+		void updateThresholds(const SystemTimeStamp& current);
+
 		EState mState = EState::Unknown;				///< Current daylight status (true = sun is above horizon)
-		std::unique_ptr<SunSet> mModel;					///< unique ptr to the sunset class
+		SystemTimeStamp mStateStamp;					///< Time the current state started
+		SystemTimeStamp mEvaluated;						///< Last evaluated time
+		SunsetService* mService = nullptr;				///< Schedules transitions
+		uint64 mServiceID = 0;							///< Id of this calculator in the service
+		std::unique_ptr<sunset::Engine> mModel;			///< Sunrise / sunset engine
+		sunset::EEngine mEngineType = sunset::EEngine::NOAA;	///< Sunrise / sunset engine type
+		std::shared_ptr<const sunset::HorizonMask> mHorizon;	///< Horizon mask, null for the flat horizon
+		const TimeZoneMap* mTimeZoneMap = nullptr;		///< Looks up the timezone of the position, null to keep the timezone
+		std::shared_ptr<sunset::EventCache> mEventCache;	///< Events of arbitrary days, shared with background range queries
 		EDay mDay = EDay::Unknown;						///< current day
+		bool mProvisional = false;						///< If the events of the current day are estimated
 
 		SystemTimeStamp mSunRiseStamp;					///< Sunrise timestamp
 		DateTime mSunRise;								///< Sunrise date-time=
 		double mSunriseOffset = 0.0;					///< Sunrise offset in minutes
 
 		SystemTimeStamp mSunSetStamp;					///< Sunset timestamp
+		bool mHasSunRise = true;						///< If the sun rises on the current day, the sunrise is midnight otherwise
+		bool mHasSunSet = true;							///< If the sun sets on the current day, the sunset is the next midnight when up, midnight when down all day
+		SystemTimeStamp mNextSunRiseStamp;				///< Sunrise timestamp of the next day
+		SystemTimeStamp mMidnight;						///< Local midnight of the current day
+		SystemTimeStamp mNextMidnight;					///< Local midnight of the next day
+		sunset::SolarTerms mTerms;						///< Solar terms of the current day, for the sun position
 		DateTime mSunset;								///< Sunset date-time
 		double mSunsetOffset = 0.0;						///< Sunset offset in minutes
 
-		int mTimezone = 0;								///< Location timezone
+		double mTimezone = 0.0;							///< Location timezone
 		double mLatitude = 0;							///< Location latitude
 		double mLongitude = 0;							///< Location longitude
+		double mEventLatitude = 0;						///< Latitude the events are computed for
+		double mEventLongitude = 0;						///< Longitude the events are computed for
+		double mLatitudeSensitivity = 0;				///< Estimated sunrise / sunset shift in seconds per degree of latitude
+		double mPositionTolerance = 10.0;				///< Max estimated shift in seconds before events are recomputed
+
+		std::vector<Threshold> mThresholds;				///< Elevation thresholds, sorted from low to high
 	};
 }
@@ -0,0 +1,309 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetchebyshev.h"
+
+#include <sunset.h>
+#include <algorithm>
+#include <cmath>
+
+namespace nap
+{
+	namespace sunset
+	{
+		static constexpr int maxSeriesDegree = 16;
+
+		// Float coefficients can't represent minutes much more precisely than this
+		static constexpr double minError = 0.01;
+
+
+		static bool isLeapYear(int year)
+		{
+			return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+		}
+
+
+		/**
+		 * Maps a day of a segment onto [-1, 1]
+		 */
+		static double toChebyshev(int day, int firstDay, int dayCount)
+		{
+			return dayCount > 1 ? 2.0 * (day - firstDay) / (dayCount - 1) - 1.0 : 0.0;
+		}
+
+
+		/**
+		 * Clenshaw's recurrence for a Chebyshev series
+		 */
+		static double clenshaw(const float* coefficients, int count, double x)
+		{
+			double b1 = 0.0, b2 = 0.0;
+			for (int k = count - 1; k > 0; k--)
+			{
+				double b0 = 2.0 * x * b1 - b2 + coefficients[k];
+				b2 = b1;
+				b1 = b0;
+			}
+			return x * b1 - b2 + coefficients[0];
+		}
+
+
+		double ChebyshevSeries::evaluate(int dayOfYear) const
+		{
+			// Last segment starting at or before the day
+			auto it = std::upper_bound(mSegments.begin(), mSegments.end(), dayOfYear,
+				[](int day, const Segment& segment) { return day < segment.mFirstDay; });
+			if (it == mSegments.begin())
+				return NAN;
+
+			const auto& segment = *(--it);
+			if (dayOfYear >= segment.mFirstDay + segment.mDayCount || segment.mCount == 0)
+				return NAN;
+			return clenshaw(&mCoefficients[segment.mOffset], segment.mCount, toChebyshev(dayOfYear, segment.mFirstDay, segment.mDayCount));
+		}
+
+
+		bool CompressedYear::evaluate(int dayOfYear, double timezone, double& outSunrise, double& outSunset) const
+		{
+			if (dayOfYear < 0 || dayOfYear >= getDayCount())
+				return false;
+
+			outSunrise = mSunrise.evaluate(dayOfYear) + 60.0 * timezone;
+			outSunset = mSunset.evaluate(dayOfYear) + 60.0 * timezone;
+			return true;
+		}
+
+
+		int CompressedYear::getDayCount() const
+		{
+			return isLeapYear(mYear) ? 366 : 365;
+		}
+
+
+		size_t CompressedYear::getByteSize() const
+		{
+			return sizeof(CompressedYear) +
+				(mSunrise.mSegments.size() + mSunset.mSegments.size()) * sizeof(ChebyshevSeries::Segment) +
+				(mSunrise.mCoefficients.size() + mSunset.mCoefficients.size()) * sizeof(float);
+		}
+
+
+		/**
+		 * Computes the official sunrise and sunset in minutes past midnight UTC of every day of a year
+		 */
+		static void sampleYear(double latitude, double longitude, int year, std::vector<double>& outSunrises, std::vector<double>& outSunsets)
+		{
+			static constexpr int daysInMonth[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+			SunSet model;
+			model.setPosition(latitude, longitude, 0.0);
+			outSunrises.clear();
+			outSunsets.clear();
+			for (int month = 1; month <= 12; month++)
+			{
+				int days = daysInMonth[month - 1] + (month == 2 && isLeapYear(year) ? 1 : 0);
+				for (int day = 1; day <= days; day++)
+				{
+					model.setCurrentDate(year, month, day);
+					outSunrises.emplace_back(model.calcSunrise());
+					outSunsets.emplace_back(model.calcSunset());
+				}
+			}
+		}
+
+
+		/**
+		 * Least squares fit of a Chebyshev series to the values of a range of days.
+		 * Solves the normal equations with Gaussian elimination, well conditioned for low degrees on evenly spaced days.
+		 */
+		static void fitSeries(const double* values, int dayCount, int count, float* outCoefficients)
+		{
+			double a[maxSeriesDegree + 1][maxSeriesDegree + 2] = {};
+			double t[maxSeriesDegree + 1];
+			for (int i = 0; i < dayCount; i++)
+			{
+				double x = toChebyshev(i, 0, dayCount);
+				t[0] = 1.0;
+				if (count > 1)
+					t[1] = x;
+				for (int k = 2; k < count; k++)
+					t[k] = 2.0 * x * t[k - 1] - t[k - 2];
+
+				for (int r = 0; r < count; r++)
+				{
+					for (int c = 0; c < count; c++)
+						a[r][c] += t[r] * t[c];
+					a[r][count] += t[r] * values[i];
+				}
+			}
+
+			// Eliminate with partial pivoting
+			for (int c = 0; c < count; c++)
+			{
+				int pivot = c;
+				for (int r = c + 1; r < count; r++)
+					pivot = std::abs(a[r][c]) > std::abs(a[pivot][c]) ? r : pivot;
+				std::swap(a[c], a[pivot]);
+
+				for (int r = c + 1; r < count; r++)
+				{
+					double f = a[r][c] / a[c][c];
+					for (int k = c; k <= count; k++)
+						a[r][k] -= f * a[c][k];
+				}
+			}
+
+			// Back substitute
+			double solution[maxSeriesDegree + 1];
+			for (int r = count - 1; r >= 0; r--)
+			{
+				double sum = a[r][count];
+				for (int c = r + 1; c < count; c++)
+					sum -= a[r][c] * solution[c];
+				solution[r] = sum / a[r][r];
+				outCoefficients[r] = static_cast<float>(solution[r]);
+			}
+		}
+
+
+		/**
+		 * Fits a range of days with a series of the given number of coefficients
+		 * @return largest deviation of the single precision series in minutes
+		 */
+		static double fitRange(const double* values, int dayCount, int count, float* outCoefficients)
+		{
+			fitSeries(values, dayCount, count, outCoefficients);
+			double error = 0.0;
+			for (int i = 0; i < dayCount; i++)
+				error = std::max(error, std::abs(clenshaw(outCoefficients, count, toChebyshev(i, 0, dayCount)) - values[i]));
+			return error;
+		}
+
+
+		/**
+		 * Covers a range of days with as few segments as possible: every segment is extended as far as the
+		 * error bound allows, found by bisecting its length, after which the number of coefficients is reduced
+		 * while the segment stays within the bound. Segments of up to maxDegree + 1 days are interpolated exactly.
+		 * @param maxError error bound in minutes
+		 */
+		static void compressRange(const std::vector<double>& values, int firstDay, int dayCount, double maxError, int maxDegree, ChebyshevSeries& outSeries)
+		{
+			float coefficients[maxSeriesDegree + 1];
+			int end = firstDay + dayCount;
+			while (firstDay < end)
+			{
+				// Longest segment within the bound
+				int low = std::min(maxDegree + 1, end - firstDay);
+				int high = end - firstDay;
+				while (low < high)
+				{
+					int length = (low + high + 1) / 2;
+					if (fitRange(&values[firstDay], length, maxDegree + 1, coefficients) <= maxError)
+						low = length;
+					else
+						high = length - 1;
+				}
+
+				// Fewest coefficients within the bound
+				int count = std::min(maxDegree + 1, low);
+				while (count > 1 && fitRange(&values[firstDay], low, count - 1, coefficients) <= maxError)
+					count--;
+				fitSeries(&values[firstDay], low, count, coefficients);
+
+				ChebyshevSeries::Segment segment;
+				segment.mFirstDay = static_cast<uint16>(firstDay);
+				segment.mDayCount = static_cast<uint16>(low);
+				segment.mOffset = static_cast<uint16>(outSeries.mCoefficients.size());
+				segment.mCount = static_cast<uint16>(count);
+				outSeries.mSegments.emplace_back(segment);
+				outSeries.mCoefficients.insert(outSeries.mCoefficients.end(), coefficients, coefficients + count);
+				firstDay += low;
+			}
+		}
+
+
+		/**
+		 * Compresses a year of daily values, runs of undefined days become empty segments
+		 */
+		static void compressSeries(const std::vector<double>& values, double maxError, int maxDegree, ChebyshevSeries& outSeries)
+		{
+			outSeries.mSegments.clear();
+			outSeries.mCoefficients.clear();
+
+			int day_count = static_cast<int>(values.size());
+			int first = 0;
+			while (first < day_count)
+			{
+				bool defined = !std::isnan(values[first]);
+				int last = first + 1;
+				while (last < day_count && !std::isnan(values[last]) == defined)
+					last++;
+
+				if (defined)
+				{
+					compressRange(values, first, last - first, maxError, maxDegree, outSeries);
+				}
+				else
+				{
+					ChebyshevSeries::Segment segment;
+					segment.mFirstDay = static_cast<uint16>(first);
+					segment.mDayCount = static_cast<uint16>(last - first);
+					segment.mOffset = static_cast<uint16>(outSeries.mCoefficients.size());
+					outSeries.mSegments.emplace_back(segment);
+				}
+				first = last;
+			}
+		}
+
+
+		bool compressYear(double latitude, double longitude, int year, double maxError, int maxDegree,
+			CompressedYear& outYear, utility::ErrorState& error)
+		{
+			if (!error.check(maxError >= minError, "error bound of %.3f seconds is below %.2f seconds", maxError, minError))
+				return false;
+
+			if (!error.check(maxDegree >= 1 && maxDegree <= maxSeriesDegree, "degree %d out of range, must be 1 to %d", maxDegree, maxSeriesDegree))
+				return false;
+
+			std::vector<double> sunrises, sunsets;
+			sampleYear(latitude, longitude, year, sunrises, sunsets);
+
+			outYear.mLatitude = latitude;
+			outYear.mLongitude = longitude;
+			outYear.mYear = year;
+			outYear.mMaxError = maxError;
+			compressSeries(sunrises, maxError / 60.0, maxDegree, outYear.mSunrise);
+			compressSeries(sunsets, maxError / 60.0, maxDegree, outYear.mSunset);
+			return true;
+		}
+
+
+		bool validateCompressedYear(const CompressedYear& year, double tolerance, CompressionValidation& outResult, utility::ErrorState& error)
+		{
+			std::vector<double> sunrises, sunsets;
+			sampleYear(year.mLatitude, year.mLongitude, year.mYear, sunrises, sunsets);
+
+			outResult = {};
+			for (int day = 0; day < static_cast<int>(sunrises.size()); day++)
+			{
+				double reference[] = { sunrises[day], sunsets[day] };
+				double compressed[] = { year.mSunrise.evaluate(day), year.mSunset.evaluate(day) };
+				for (int i = 0; i < 2; i++)
+				{
+					if (std::isnan(reference[i]) != std::isnan(compressed[i]))
+						outResult.mMismatches++;
+					else if (!std::isnan(reference[i]))
+						outResult.mMaxError = std::max(outResult.mMaxError, std::abs(compressed[i] - reference[i]) * 60.0);
+				}
+				outResult.mDayCount++;
+			}
+
+			if (!error.check(outResult.mMismatches == 0, "compressed year disagrees with the sunset library on the sun rising or setting on %d days",
+				outResult.mMismatches))
+				return false;
+
+			return error.check(outResult.mMaxError <= tolerance, "compressed year deviates %.3f seconds, tolerance is %.3f seconds",
+				outResult.mMaxError, tolerance);
+		}
+	}
+}
@@ -0,0 +1,120 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <utility/dllexport.h>
+#include <utility/errorstate.h>
+#include <nap/numeric.h>
+#include <vector>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Piecewise Chebyshev series of a daily value over a year, for example sunrise in minutes.
+		 * Every segment covers a range of days and holds its own coefficients.
+		 */
+		struct NAPAPI ChebyshevSeries
+		{
+			/**
+			 * Range of days approximated by a single Chebyshev series.
+			 */
+			struct Segment
+			{
+				uint16 mFirstDay = 0;				///< First day of the segment, 0 = January 1st
+				uint16 mDayCount = 0;				///< Number of days in the segment
+				uint16 mOffset = 0;					///< Index of the first coefficient
+				uint16 mCount = 0;					///< Number of coefficients, 0 when the value is undefined (NaN) on these days
+			};
+
+			std::vector<Segment> mSegments;			///< Segments, sorted by first day
+			std::vector<float> mCoefficients;		///< Coefficients of all segments
+
+			/**
+			 * Evaluates the series using Clenshaw's recurrence, 2 multiply-adds per coefficient.
+			 * @param dayOfYear the day to evaluate, 0 = January 1st
+			 * @return the approximated value, NaN when undefined or out of range
+			 */
+			double evaluate(int dayOfYear) const;
+		};
+
+
+		/**
+		 * Official sunrise and sunset of a location over a year, compressed into piecewise Chebyshev series.
+		 * A year typically takes a few dozen coefficients, instead of a value per day.
+		 * Create one using sunset::compressYear().
+		 */
+		struct NAPAPI CompressedYear
+		{
+			double mLatitude = 0.0;					///< Latitude in degrees
+			double mLongitude = 0.0;				///< Longitude in degrees
+			int mYear = 0;							///< 4 digit year
+			double mMaxError = 0.0;					///< Error bound in seconds the year was compressed with
+			ChebyshevSeries mSunrise;				///< Sunrise in minutes past midnight UTC
+			ChebyshevSeries mSunset;				///< Sunset in minutes past midnight UTC
+
+			/**
+			 * @param dayOfYear the day to evaluate, 0 = January 1st
+			 * @param timezone timezone offset in hours, including daylight saving
+			 * @param outSunrise receives sunrise in minutes past local midnight, NaN if the sun doesn't rise
+			 * @param outSunset receives sunset in minutes past local midnight, NaN if the sun doesn't set
+			 * @return if the day is part of the year
+			 */
+			bool evaluate(int dayOfYear, double timezone, double& outSunrise, double& outSunset) const;
+
+			/**
+			 * @return number of days in the year
+			 */
+			int getDayCount() const;
+
+			/**
+			 * @return approximate memory footprint in bytes
+			 */
+			size_t getByteSize() const;
+		};
+
+
+		/**
+		 * Computes the official sunrise and sunset of every day of a year using the sunset library and
+		 * fits them with piecewise Chebyshev series. Every segment is made as long as possible while its series,
+		 * stored in single precision, is within the error bound on every day of the segment.
+		 * Days the sun doesn't rise or set are stored as empty segments.
+		 * @param latitude latitude in degrees
+		 * @param longitude longitude in degrees
+		 * @param year 4 digit year
+		 * @param maxError error bound in seconds, at least 0.01
+		 * @param maxDegree max degree of every series, 1 to 16
+		 * @param outYear receives the compressed year
+		 * @param error contains the error if the settings are invalid
+		 * @return if compression succeeded
+		 */
+		bool NAPAPI compressYear(double latitude, double longitude, int year, double maxError, int maxDegree,
+			CompressedYear& outYear, utility::ErrorState& error);
+
+
+		/**
+		 * Outcome of validating a compressed year.
+		 */
+		struct CompressionValidation
+		{
+			int mDayCount = 0;						///< Number of days that were compared
+			double mMaxError = 0.0;					///< Largest absolute deviation from the sunset library in seconds
+			int mMismatches = 0;					///< Days on which the compressed year and the library disagree on the sun rising or setting
+		};
+
+		/**
+		 * Validates a compressed year against the sunset library on every day of the year.
+		 * Validation fails when the sunrise or sunset of any day deviates more than 'tolerance' seconds,
+		 * or when the compressed year and the library disagree on the sun rising or setting.
+		 * @param year the compressed year
+		 * @param tolerance maximum allowed deviation in seconds
+		 * @param outResult holds the measured deviation, also when validation fails
+		 * @param error contains the error if validation fails
+		 * @return if the compressed year is within tolerance
+		 */
+		bool NAPAPI validateCompressedYear(const CompressedYear& year, double tolerance, CompressionValidation& outResult, utility::ErrorState& error);
+	}
+}
@@ -0,0 +1,348 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <array>
+#include <limits>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Compile time implementation of the sunset library (NOAA) math, including trigonometry.
+		 * Mirrors BasicSunSet<double> step by step, results match the runtime library to well within a second.
+		 * Used to bake sunrise / sunset tables into the binary, too slow to use at runtime.
+		 */
+		namespace cx
+		{
+			constexpr double pi = 3.14159265358979323846;
+			constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+			constexpr bool isnan(double x)					{ return x != x; }
+			constexpr double abs(double x)					{ return x < 0.0 ? -x : x; }
+			constexpr double degToRad(double x)				{ return pi * x / 180.0; }
+			constexpr double radToDeg(double x)				{ return 180.0 * x / pi; }
+
+			/**
+			 * @return largest integer value not greater than x, x must fit a 64 bit integer
+			 */
+			constexpr double floor(double x)
+			{
+				double i = static_cast<double>(static_cast<long long>(x));
+				return i > x ? i - 1.0 : i;
+			}
+
+			/**
+			 * @return remainder of x / y with the sign of x, as std::fmod
+			 */
+			constexpr double fmod(double x, double y)
+			{
+				double q = static_cast<double>(static_cast<long long>(x / y));
+				return x - q * y;
+			}
+
+			/**
+			 * Newton-Raphson square root.
+			 */
+			constexpr double sqrt(double x)
+			{
+				if (x < 0.0)
+					return nan;
+				if (x == 0.0)
+					return 0.0;
+
+				double r = x > 1.0 ? x : 1.0;
+				for (int i = 0; i < 128; i++)
+				{
+					double next = 0.5 * (r + x / r);
+					if (next >= r)
+						break;
+					r = next;
+				}
+				return r;
+			}
+
+			/**
+			 * Taylor series after reducing the argument to [-pi/2, pi/2].
+			 */
+			constexpr double sin(double x)
+			{
+				x = fmod(x, 2.0 * pi);
+				if (x > pi)
+					x -= 2.0 * pi;
+				else if (x < -pi)
+					x += 2.0 * pi;
+
+				if (x > 0.5 * pi)
+					x = pi - x;
+				else if (x < -0.5 * pi)
+					x = -pi - x;
+
+				double term = x, sum = x, x2 = x * x;
+				for (int n = 1; n < 16; n++)
+				{
+					term *= -x2 / ((2.0 * n) * (2.0 * n + 1.0));
+					sum += term;
+				}
+				return sum;
+			}
+
+			constexpr double cos(double x)					{ return sin(x + 0.5 * pi); }
+			constexpr double tan(double x)					{ return sin(x) / cos(x); }
+
+			/**
+			 * Taylor series after halving the argument twice, |x| <= 1 / 4.
+			 */
+			constexpr double atan(double x)
+			{
+				if (x < 0.0)
+					return -atan(-x);
+				if (x > 1.0)
+					return 0.5 * pi - atan(1.0 / x);
+
+				// atan(x) = 2 atan(x / (1 + sqrt(1 + x^2)))
+				double scale = 1.0;
+				for (int i = 0; i < 2; i++)
+				{
+					x = x / (1.0 + sqrt(1.0 + x * x));
+					scale *= 2.0;
+				}
+
+				double term = x, sum = x, x2 = x * x;
+				for (int n = 1; n < 16; n++)
+				{
+					term *= -x2;
+					sum += term / (2.0 * n + 1.0);
+				}
+				return scale * sum;
+			}
+
+			/**
+			 * @return arc sine, NaN outside [-1, 1]
+			 */
+			constexpr double asin(double x)
+			{
+				if (x < -1.0 || x > 1.0)
+					return nan;
+				if (x == 1.0 || x == -1.0)
+					return x * 0.5 * pi;
+				return atan(x / sqrt(1.0 - x * x));
+			}
+
+			/**
+			 * @return arc cosine, NaN outside [-1, 1]
+			 */
+			constexpr double acos(double x)
+			{
+				double s = asin(x);
+				return isnan(s) ? nan : 0.5 * pi - s;
+			}
+
+
+			//////////////////////////////////////////////////////////////////////////
+			// Sunset library math
+			//////////////////////////////////////////////////////////////////////////
+
+			constexpr double calcJD(int y, int m, int d)
+			{
+				if (m <= 2)
+				{
+					y -= 1;
+					m += 12;
+				}
+				double a = floor(y / 100);
+				double b = 2.0 - a + floor(a / 4);
+				return floor(365.25 * (y + 4716)) + floor(30.6001 * (m + 1)) + d + b - 1524.5;
+			}
+
+			constexpr double calcTimeJulianCent(double jd)			{ return (jd - 2451545.0) / 36525.0; }
+
+			constexpr double calcMeanObliquityOfEcliptic(double t)
+			{
+				double seconds = 21.448 - t * (46.8150 + t * (0.00059 - t * 0.001813));
+				return 23.0 + (26.0 + (seconds / 60.0)) / 60.0;
+			}
+
+			constexpr double calcGeomMeanLongSun(double t)
+			{
+				return fmod(280.46646 + t * (36000.76983 + 0.0003032 * t), 360.0);
+			}
+
+			constexpr double calcObliquityCorrection(double t)
+			{
+				double omega = 125.04 - 1934.136 * t;
+				return calcMeanObliquityOfEcliptic(t) + 0.00256 * cos(degToRad(omega));
+			}
+
+			constexpr double calcEccentricityEarthOrbit(double t)	{ return 0.016708634 - t * (0.000042037 + 0.0000001267 * t); }
+			constexpr double calcGeomMeanAnomalySun(double t)		{ return 357.52911 + t * (35999.05029 - 0.0001537 * t); }
+
+			constexpr double calcEquationOfTime(double t)
+			{
+				double epsilon = calcObliquityCorrection(t);
+				double l0 = calcGeomMeanLongSun(t);
+				double e = calcEccentricityEarthOrbit(t);
+				double m = calcGeomMeanAnomalySun(t);
+				double y = tan(degToRad(epsilon) / 2.0);
+				y *= y;
+
+				double sin2l0 = sin(2.0 * degToRad(l0));
+				double sinm = sin(degToRad(m));
+				double cos2l0 = cos(2.0 * degToRad(l0));
+				double sin4l0 = sin(4.0 * degToRad(l0));
+				double sin2m = sin(2.0 * degToRad(m));
+				double etime = y * sin2l0 - 2.0 * e * sinm + 4.0 * e * y * sinm * cos2l0 - 0.5 * y * y * sin4l0 - 1.25 * e * e * sin2m;
+				return radToDeg(etime) * 4.0;
+			}
+
+			constexpr double calcSunEqOfCenter(double t)
+			{
+				double mrad = degToRad(calcGeomMeanAnomalySun(t));
+				return sin(mrad) * (1.914602 - t * (0.004817 + 0.000014 * t)) + sin(mrad + mrad) * (0.019993 - 0.000101 * t) +
+					sin(mrad + mrad + mrad) * 0.000289;
+			}
+
+			constexpr double calcSunApparentLong(double t)
+			{
+				double o = calcGeomMeanLongSun(t) + calcSunEqOfCenter(t);
+				double omega = 125.04 - 1934.136 * t;
+				return o - 0.00569 - 0.00478 * sin(degToRad(omega));
+			}
+
+			constexpr double calcSunDeclination(double t)
+			{
+				double e = calcObliquityCorrection(t);
+				double lambda = calcSunApparentLong(t);
+				return radToDeg(asin(sin(degToRad(e)) * sin(degToRad(lambda))));
+			}
+
+			constexpr double calcHourAngle(double lat, double solarDec, double zenith)
+			{
+				double lat_rad = degToRad(lat);
+				double sd_rad = degToRad(solarDec);
+				return acos(cos(degToRad(zenith)) / (cos(lat_rad) * cos(sd_rad)) - tan(lat_rad) * tan(sd_rad));
+			}
+
+			/**
+			 * Two pass sunrise or sunset, as BasicSunSet::calcAbsSunrise() and calcAbsSunset().
+			 * @param jd julian day at 0h UT
+			 * @param sign 1 for sunrise, -1 for sunset
+			 * @return crossing in minutes past midnight UTC, NaN if the sun doesn't cross the zenith angle
+			 */
+			constexpr double calcAbsCrossing(double jd, double latitude, double longitude, double zenith, double sign)
+			{
+				double t = calcTimeJulianCent(jd);
+				double time_utc = 0.0;
+				for (int pass = 0; pass < 2; pass++)
+				{
+					double hour_angle = calcHourAngle(latitude, calcSunDeclination(t), zenith);
+					if (isnan(hour_angle))
+						return nan;
+
+					double delta = longitude + radToDeg(sign * hour_angle);
+					time_utc = 720.0 - 4.0 * delta - calcEquationOfTime(t);
+					t = calcTimeJulianCent(jd) + time_utc / (1440.0 * 36525.0);
+				}
+				return time_utc;
+			}
+
+			/**
+			 * @return official sunrise in minutes past midnight UTC, NaN if the sun doesn't rise or set
+			 */
+			constexpr double calcSunriseUTC(int year, int month, int day, double latitude, double longitude)
+			{
+				return calcAbsCrossing(calcJD(year, month, day), latitude, longitude, 90.833, 1.0);
+			}
+
+			/**
+			 * @return official sunset in minutes past midnight UTC, NaN if the sun doesn't rise or set
+			 */
+			constexpr double calcSunsetUTC(int year, int month, int day, double latitude, double longitude)
+			{
+				return calcAbsCrossing(calcJD(year, month, day), latitude, longitude, 90.833, -1.0);
+			}
+
+
+			//////////////////////////////////////////////////////////////////////////
+			// Baked tables
+			//////////////////////////////////////////////////////////////////////////
+
+			/**
+			 * Official sunrise and sunset of a single day in minutes past midnight UTC.
+			 */
+			struct BakedDay
+			{
+				float mSunrise = 0.0f;
+				float mSunset = 0.0f;
+			};
+
+			constexpr bool isLeapYear(int year)				{ return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0; }
+			constexpr int daysInYear(int year)				{ return isLeapYear(year) ? 366 : 365; }
+
+			constexpr int daysInMonth(int year, int month)
+			{
+				constexpr int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+				return month == 2 && isLeapYear(year) ? 29 : days[month - 1];
+			}
+
+			/**
+			 * @return number of days in the given range of years
+			 */
+			constexpr int bakedDayCount(int firstYear, int years)
+			{
+				int count = 0;
+				for (int year = firstYear; year < firstYear + years; year++)
+					count += daysInYear(year);
+				return count;
+			}
+
+			/**
+			 * @return day index of a date relative to January 1st of the first year, negative before
+			 */
+			constexpr int bakedDayIndex(int firstYear, int year, int month, int day)
+			{
+				int index = 0;
+				for (int y = firstYear; y < year; y++)
+					index += daysInYear(y);
+				for (int y = year; y < firstYear; y++)
+					index -= daysInYear(y);
+				for (int m = 1; m < month; m++)
+					index += daysInMonth(year, m);
+				return index + day - 1;
+			}
+
+			/**
+			 * Computes the official sunrise and sunset of every day in a range of years, in order.
+			 * Meant to initialize a constexpr table, Count must equal bakedDayCount(firstYear, years).
+			 */
+			template<int Count>
+			constexpr std::array<BakedDay, Count> bakeTable(double latitude, double longitude, int firstYear)
+			{
+				std::array<BakedDay, Count> table = {};
+				int year = firstYear, month = 1, day = 1;
+				for (int i = 0; i < Count; i++)
+				{
+					double jd = calcJD(year, month, day);
+					double sunrise = calcAbsCrossing(jd, latitude, longitude, 90.833, 1.0);
+					double sunset = calcAbsCrossing(jd, latitude, longitude, 90.833, -1.0);
+					table[i].mSunrise = isnan(sunrise) ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>(sunrise);
+					table[i].mSunset = isnan(sunset) ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>(sunset);
+
+					if (++day > daysInMonth(year, month))
+					{
+						day = 1;
+						if (++month > 12)
+						{
+							month = 1;
+							year++;
+						}
+					}
+				}
+				return table;
+			}
+		}
+	}
+}
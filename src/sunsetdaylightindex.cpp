@@ -0,0 +1,93 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetdaylightindex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nap
+{
+	namespace sunset
+	{
+		// Number of days computed by a worker in one go, keeps the totals of a site written by different workers apart
+		static constexpr size_t dayBlockSize = 16;
+
+		// Number of sites summed by a worker in one go
+		static constexpr size_t siteBlockSize = 64;
+
+		// Max number of days in the span, 200 years
+		static constexpr int maxDayCount = 73050;
+
+
+		bool DaylightIndex::build(const Location* locations, size_t count, const Day& first, int dayCount, utility::ErrorState& error, int threadCount, EEngine engine)
+		{
+			if (!error.check(dayCount > 0 && dayCount <= maxDayCount, "number of days out of range: %d", dayCount))
+				return false;
+
+			mSiteCount = count;
+			mFirstDay = toDayNumber(first);
+			mDayCount = dayCount;
+			size_t stride = static_cast<size_t>(dayCount) + 1;
+			mTotals.assign(count * stride, 0.0);
+			if (count == 0)
+				return true;
+
+			// Daylight of every day, stored after the total of the previous day
+			size_t day_blocks = (static_cast<size_t>(dayCount) + dayBlockSize - 1) / dayBlockSize;
+			parallelFor(day_blocks, threadCount, [&](size_t block)
+			{
+				// Declination decides between polar day and night, it hardly changes over a day
+				auto model = createEngine(EEngine::NOAA);
+				model->setPosition(0.0, 0.0, 0.0);
+				std::vector<Events> events(count);
+				SolarTerms terms;
+
+				size_t end = std::min((block + 1) * dayBlockSize, static_cast<size_t>(dayCount));
+				for (size_t d = block * dayBlockSize; d < end; d++)
+				{
+					Day day = fromDayNumber(mFirstDay + static_cast<int>(d));
+					computeEvents(locations, count, day, events.data(), 1, engine);
+
+					model->setDate(day.mYear, day.mMonth, day.mDay);
+					model->calcSolarTerms(terms);
+					double declination = terms.mDeclination[1];
+
+					double* totals = mTotals.data() + d + 1;
+					for (size_t i = 0; i < count; i++, totals += stride)
+						*totals = sunset::getDayLength(events[i], locations[i].mLatitude, declination);
+				}
+			});
+
+			// Running totals per site
+			size_t site_blocks = (count + siteBlockSize - 1) / siteBlockSize;
+			parallelFor(site_blocks, threadCount, [&](size_t block)
+			{
+				size_t end = std::min((block + 1) * siteBlockSize, count);
+				for (size_t i = block * siteBlockSize; i < end; i++)
+				{
+					double* totals = mTotals.data() + i * stride;
+					for (size_t d = 1; d < stride; d++)
+						totals[d] += totals[d - 1];
+				}
+			});
+			return true;
+		}
+
+
+		double DaylightIndex::getDaylight(size_t site, int first, int last) const
+		{
+			if (site >= mSiteCount)
+				return 0.0;
+
+			int begin = std::max(first - mFirstDay, 0);
+			int end = std::min(last - mFirstDay + 1, mDayCount);
+			if (begin >= end)
+				return 0.0;
+
+			const double* totals = mTotals.data() + site * (static_cast<size_t>(mDayCount) + 1);
+			return totals[end] - totals[begin];
+		}
+	}
+}
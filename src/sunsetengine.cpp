@@ -0,0 +1,205 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetengine.h"
+#include "sunsetspa.h"
+#include "sunsetbaked.h"
+
+#include <sunset.h>
+#include <cmath>
+
+namespace nap
+{
+	namespace sunset
+	{
+		static constexpr double pi = 3.14159265358979323846;
+		static constexpr double degToRad = pi / 180.0;
+		static constexpr double radToDeg = 180.0 / pi;
+
+
+		//////////////////////////////////////////////////////////////////////////
+		// NOAA engine: wraps the sunset library
+		//////////////////////////////////////////////////////////////////////////
+
+		class NOAAEngine : public Engine
+		{
+		public:
+			void setDate(int year, int month, int day) override
+			{
+				mModel.setCurrentDate(year, month, day);
+			}
+
+			void setPosition(double latitude, double longitude, double timezone) override
+			{
+				mModel.setPosition(latitude, longitude, timezone);
+				mLatitude = latitude;
+				mLongitude = longitude;
+				mTimezone = timezone;
+			}
+
+			double calcCustomSunrise(double zenith) const override
+			{
+				return mModel.calcCustomSunrise(zenith);
+			}
+
+			double calcCustomSunset(double zenith) const override
+			{
+				return mModel.calcCustomSunset(zenith);
+			}
+
+			void calcElevationCrossings(const double* elevations, int count, double* outSunrises, double* outSunsets) const override
+			{
+				mModel.calcElevationCrossings(elevations, count, outSunrises, outSunsets);
+			}
+
+			void calcSolarTerms(SolarTerms& outTerms) const override
+			{
+				outTerms.mLatitude = mLatitude;
+				outTerms.mLongitude = mLongitude;
+				outTerms.mTimezone = mTimezone;
+				for (int i = 0; i < SolarTerms::sampleCount; i++)
+					mModel.calcSolarTerms(720.0 * i, outTerms.mDeclination[i], outTerms.mEquationOfTime[i]);
+			}
+
+		private:
+			SunSet mModel;
+			double mLatitude = 0.0;
+			double mLongitude = 0.0;
+			double mTimezone = 0.0;
+		};
+
+
+		//////////////////////////////////////////////////////////////////////////
+		// Fast engine: solar terms once per day, single pass per crossing
+		//////////////////////////////////////////////////////////////////////////
+
+		class FastEngine : public Engine
+		{
+		public:
+			void setDate(int year, int month, int day) override
+			{
+				// Day of the year, 0 based
+				static constexpr int cumulative[] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+				bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+				mDayOfYear = cumulative[month - 1] + day - 1 + (leap && month > 2 ? 1 : 0);
+				mDaysInYear = leap ? 366.0 : 365.0;
+				updateTerms();
+			}
+
+			void setPosition(double latitude, double longitude, double timezone) override
+			{
+				mLatitude = latitude;
+				mLongitude = longitude;
+				mTimezone = timezone;
+				updateTerms();
+			}
+
+			double calcCustomSunrise(double zenith) const override
+			{
+				double cos_ha = hourAngleCosine(90.0 - zenith);
+				return std::abs(cos_ha) > 1.0 ? NAN : crossing(std::acos(cos_ha) * radToDeg);
+			}
+
+			double calcCustomSunset(double zenith) const override
+			{
+				double cos_ha = hourAngleCosine(90.0 - zenith);
+				return std::abs(cos_ha) > 1.0 ? NAN : crossing(-std::acos(cos_ha) * radToDeg);
+			}
+
+			void calcElevationCrossings(const double* elevations, int count, double* outSunrises, double* outSunsets) const override
+			{
+				for (int i = 0; i < count; i++)
+				{
+					double cos_ha = hourAngleCosine(elevations[i]);
+					if (cos_ha > 1.0)
+					{
+						outSunrises[i] = outSunsets[i] = NAN;
+						continue;
+					}
+
+					if (cos_ha < -1.0)
+					{
+						outSunrises[i] = -INFINITY;
+						outSunsets[i] = INFINITY;
+						continue;
+					}
+
+					double ha = std::acos(cos_ha) * radToDeg;
+					outSunrises[i] = crossing(ha);
+					outSunsets[i] = crossing(-ha);
+				}
+			}
+
+			void calcSolarTerms(SolarTerms& outTerms) const override
+			{
+				outTerms.mLatitude = mLatitude;
+				outTerms.mLongitude = mLongitude;
+				outTerms.mTimezone = mTimezone;
+				for (int i = 0; i < SolarTerms::sampleCount; i++)
+				{
+					outTerms.mDeclination[i] = mDeclination * radToDeg;
+					outTerms.mEquationOfTime[i] = mEquationOfTime;
+				}
+			}
+
+		private:
+			// Declination and equation of time at local noon (NOAA general solar position)
+			void updateTerms()
+			{
+				double hour = 12.0 - mLongitude / 15.0;
+				double gamma = 2.0 * pi / mDaysInYear * (mDayOfYear + (hour - 12.0) / 24.0);
+				mEquationOfTime = 229.18 * (0.000075 + 0.001868 * std::cos(gamma) - 0.032077 * std::sin(gamma) -
+					0.014615 * std::cos(2.0 * gamma) - 0.040849 * std::sin(2.0 * gamma));
+				mDeclination = 0.006918 - 0.399912 * std::cos(gamma) + 0.070257 * std::sin(gamma) -
+					0.006758 * std::cos(2.0 * gamma) + 0.000907 * std::sin(2.0 * gamma) -
+					0.002697 * std::cos(3.0 * gamma) + 0.00148 * std::sin(3.0 * gamma);
+			}
+
+			double hourAngleCosine(double elevation) const
+			{
+				double lat = mLatitude * degToRad;
+				return (std::sin(elevation * degToRad) - std::sin(lat) * std::sin(mDeclination)) /
+					(std::cos(lat) * std::cos(mDeclination));
+			}
+
+			double crossing(double hourAngle) const
+			{
+				return 720.0 - 4.0 * (mLongitude + hourAngle) - mEquationOfTime + 60.0 * mTimezone;
+			}
+
+			double mLatitude = 0.0;
+			double mLongitude = 0.0;
+			double mTimezone = 0.0;
+			int mDayOfYear = 0;
+			double mDaysInYear = 365.0;
+			double mDeclination = 0.0;			///< Solar declination in radians
+			double mEquationOfTime = 0.0;		///< Equation of time in minutes
+		};
+
+
+		bool Engine::calcHorizonCrossings(const HorizonMask& mask, double& outSunrise, double& outSunset) const
+		{
+			SolarTerms terms;
+			calcSolarTerms(terms);
+			return sunset::calcHorizonCrossings(terms, mask, outSunrise, outSunset);
+		}
+
+
+		std::unique_ptr<Engine> createEngine(EEngine type)
+		{
+			switch (type)
+			{
+			case EEngine::Fast:
+				return std::make_unique<FastEngine>();
+			case EEngine::Precise:
+				return std::make_unique<SPAEngine>();
+			case EEngine::Baked:
+				return std::make_unique<BakedEngine>();
+			case EEngine::NOAA:
+			default:
+				return std::make_unique<NOAAEngine>();
+			}
+		}
+	}
+}
@@ -0,0 +1,116 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "sunsethorizon.h"
+
+#include <utility/dllexport.h>
+#include <memory>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Available sunrise / sunset engines, trading cost for accuracy.
+		 */
+		enum class EEngine : int
+		{
+			NOAA		= 0,	///< NOAA based model of the sunset library, accurate to about a minute
+			Fast		= 1,	///< Single pass approximation, solar terms are computed once per day, accurate to a few minutes
+			Precise		= 2,	///< SPA class model: VSOP87 sun position, nutation and interpolated rise / set, accurate to seconds
+			Baked		= 3		///< Table of NOAA sunrise / sunset computed at compile time for a fixed location, NOAA elsewhere
+		};
+
+
+		/**
+		 * Computes local sunrise and sunset for a location and day.
+		 * All times are returned in minutes past local midnight.
+		 * Create an engine using sunset::createEngine().
+		 */
+		class NAPAPI Engine
+		{
+		public:
+			// Zenith angle of the official sunrise & sunset, including refraction and the sun's radius
+			static constexpr double officialZenith = 90.833;
+
+			// Default destructor
+			virtual ~Engine() = default;
+
+			/**
+			 * Sets the day to compute sunrise and sunset for.
+			 * @param year 4 digit year
+			 * @param month month, 1 = January
+			 * @param day day of the month, starts at 1
+			 */
+			virtual void setDate(int year, int month, int day) = 0;
+
+			/**
+			 * Sets the location to compute sunrise and sunset for.
+			 * @param latitude latitude in degrees
+			 * @param longitude longitude in degrees
+			 * @param timezone timezone offset in hours, including daylight saving
+			 */
+			virtual void setPosition(double latitude, double longitude, double timezone) = 0;
+
+			/**
+			 * @param zenith the zenith angle in degrees at which the sun rises
+			 * @return sunrise in minutes past local midnight, NaN if the sun doesn't cross the zenith angle
+			 */
+			virtual double calcCustomSunrise(double zenith) const = 0;
+
+			/**
+			 * @param zenith the zenith angle in degrees at which the sun sets
+			 * @return sunset in minutes past local midnight, NaN if the sun doesn't cross the zenith angle
+			 */
+			virtual double calcCustomSunset(double zenith) const = 0;
+
+			/**
+			 * Computes the rise and set times of a sorted list of sun elevations in one pass.
+			 * When the sun stays above an elevation all day, the sunrise is -INFINITY and the sunset INFINITY.
+			 * When the sun never reaches an elevation both are NaN.
+			 * @param elevations sun elevations in degrees over the horizon, sorted from low to high
+			 * @param count number of elevations
+			 * @param outSunrises receives the time the sun rises through every elevation, in minutes past local midnight
+			 * @param outSunsets receives the time the sun sets through every elevation, in minutes past local midnight
+			 */
+			virtual void calcElevationCrossings(const double* elevations, int count, double* outSunrises, double* outSunsets) const = 0;
+
+			/**
+			 * Computes the solar terms of the current day and location, used to solve for the sun position at any time of the day.
+			 * @param outTerms receives the solar terms
+			 */
+			virtual void calcSolarTerms(SolarTerms& outTerms) const = 0;
+
+			/**
+			 * Computes when the sun rises above and sets below a horizon mask, for example terrain or buildings.
+			 * See sunset::calcHorizonCrossings().
+			 * @param mask the horizon mask
+			 * @param outSunrise receives the first time the sun clears the mask, in minutes past local midnight
+			 * @param outSunset receives the last time the sun clears the mask, in minutes past local midnight
+			 * @return if the sun clears the mask, both times are NaN otherwise
+			 */
+			bool calcHorizonCrossings(const HorizonMask& mask, double& outSunrise, double& outSunset) const;
+
+			/**
+			 * @return official sunrise in minutes past local midnight
+			 */
+			double calcSunrise() const						{ return calcCustomSunrise(officialZenith); }
+
+			/**
+			 * @return official sunset in minutes past local midnight
+			 */
+			double calcSunset() const						{ return calcCustomSunset(officialZenith); }
+		};
+
+
+		/**
+		 * Creates a sunrise / sunset engine of the given type.
+		 * @param type the engine to create
+		 * @return the engine
+		 */
+		std::unique_ptr<Engine> NAPAPI createEngine(EEngine type);
+	}
+}
@@ -0,0 +1,143 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunseteventlog.h"
+#include "sunsetevents.h"
+
+#include <cstring>
+
+namespace nap
+{
+	namespace sunset
+	{
+		static constexpr int64 msPerDay = 24 * 60 * 60 * 1000;
+
+
+		EventLog::EventLog(size_t capacity)
+		{
+			if (capacity == 0)
+				return;
+
+			size_t size = 1;
+			while (size < capacity)
+				size <<= 1;
+			mSlots = std::make_unique<Slot[]>(size);
+			mMask = size - 1;
+		}
+
+
+		void EventLog::record(const LogRecord& record)
+		{
+			if (mSlots == nullptr)
+				return;
+
+			uint64 ticket = mHead.fetch_add(1, std::memory_order_relaxed);
+			auto& slot = mSlots[ticket & mMask];
+			slot.mSequence.store(2 * ticket + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			std::memcpy(&slot.mRecord, &record, sizeof(LogRecord));
+			slot.mSequence.store(2 * ticket + 2, std::memory_order_release);
+		}
+
+
+		bool EventLog::read(uint64 ticket, LogRecord& outRecord) const
+		{
+			const auto& slot = mSlots[ticket & mMask];
+			uint64 begin = slot.mSequence.load(std::memory_order_acquire);
+			if (begin != 2 * ticket + 2)
+				return false;
+
+			std::memcpy(&outRecord, &slot.mRecord, sizeof(LogRecord));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return slot.mSequence.load(std::memory_order_relaxed) == begin;
+		}
+
+
+		void EventLog::snapshot(std::vector<LogRecord>& outRecords) const
+		{
+			outRecords.clear();
+			if (mSlots == nullptr)
+				return;
+
+			uint64 head = mHead.load(std::memory_order_acquire);
+			uint64 first = head > mMask + 1 ? head - (mMask + 1) : 0;
+			outRecords.reserve(static_cast<size_t>(head - first));
+			LogRecord record;
+			for (uint64 ticket = first; ticket < head; ticket++)
+			{
+				if (read(ticket, record))
+					outRecords.emplace_back(record);
+			}
+		}
+
+
+		/**
+		 * Formats milliseconds since the epoch as ISO 8601 UTC
+		 */
+		static void formatTime(int64 time, char* buffer, size_t size)
+		{
+			int64 days = (time >= 0 ? time : time - msPerDay + 1) / msPerDay;
+			int64 ms = time - days * msPerDay;
+			Day day = fromDayNumber(static_cast<int>(days));
+			std::snprintf(buffer, size, "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", day.mYear, day.mMonth, day.mDay,
+				static_cast<int>(ms / 3600000), static_cast<int>(ms / 60000 % 60), static_cast<int>(ms / 1000 % 60), static_cast<int>(ms % 1000));
+		}
+
+
+		void EventLog::dump(std::FILE* file) const
+		{
+			if (mSlots == nullptr)
+				return;
+
+			uint64 head = mHead.load(std::memory_order_acquire);
+			uint64 first = head > mMask + 1 ? head - (mMask + 1) : 0;
+			std::fprintf(file, "# napsunset event log: %llu records, %llu overwritten\n",
+				static_cast<unsigned long long>(head), static_cast<unsigned long long>(first));
+
+			LogRecord record;
+			char time[32], event_time[32];
+			for (uint64 ticket = first; ticket < head; ticket++)
+			{
+				if (!read(ticket, record))
+					continue;
+
+				record.mName[logNameSize - 1] = '\0';
+				formatTime(record.mTime, time, sizeof(time));
+				formatTime(record.mEventTime, event_time, sizeof(event_time));
+				std::fprintf(file, "%llu %s %-12s %s id=%llu '%s' state=%d values=%.4f,%.4f\n",
+					static_cast<unsigned long long>(ticket), time, toString(record.mEvent), event_time,
+					static_cast<unsigned long long>(record.mCalculator), record.mName, record.mState,
+					record.mValues[0], record.mValues[1]);
+			}
+			std::fflush(file);
+		}
+
+
+		bool EventLog::dump(const std::string& path, utility::ErrorState& error) const
+		{
+			std::FILE* file = std::fopen(path.c_str(), "w");
+			if (!error.check(file != nullptr, "unable to open event log for writing: %s", path.c_str()))
+				return false;
+
+			dump(file);
+			bool written = std::ferror(file) == 0;
+			written = std::fclose(file) == 0 && written;
+			return error.check(written, "unable to write event log: %s", path.c_str());
+		}
+
+
+		const char* toString(ELogEvent event)
+		{
+			switch (event)
+			{
+			case ELogEvent::Transition:		return "Transition";
+			case ELogEvent::Elevation:		return "Elevation";
+			case ELogEvent::DayComputed:	return "DayComputed";
+			case ELogEvent::DayEstimated:	return "DayEstimated";
+			case ELogEvent::ClockJump:		return "ClockJump";
+			default:						return "Unknown";
+			}
+		}
+	}
+}
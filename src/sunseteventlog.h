@@ -0,0 +1,127 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <utility/dllexport.h>
+#include <utility/errorstate.h>
+#include <nap/numeric.h>
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Kind of event log record.
+		 */
+		enum class ELogEvent : uint8
+		{
+			Transition		= 0,	///< Sun rose or set. Values: sunrise, sunset in minutes past local midnight
+			Elevation		= 1,	///< Sun crossed an elevation threshold. Values: elevation in degrees, 1 when rising 0 when setting
+			DayComputed		= 2,	///< Events of a new day computed. Values: sunrise, sunset in minutes past local midnight
+			DayEstimated	= 3,	///< Events of a new day estimated from the previous day. Values: sunrise, sunset in minutes past local midnight
+			ClockJump		= 4		///< System clock jumped relative to the monotonic clock. Values: jump in seconds, frame time in seconds
+		};
+
+		constexpr size_t logNameSize = 32;			///< Max calculator name length in a log record, including terminator
+
+		/**
+		 * Single event log record, trivially copyable.
+		 * Timestamps are milliseconds since the UNIX epoch (UTC).
+		 */
+		struct LogRecord
+		{
+			int64 mTime = 0;						///< System time the record was made
+			int64 mEventTime = 0;					///< Time of the event, for example the exact time of a transition
+			uint64 mCalculator = 0;					///< Calculator id, 0 for service events
+			ELogEvent mEvent = ELogEvent::Transition;	///< Kind of event
+			int8 mState = -1;						///< Calculator state after the event, -1 = unknown, 0 = down, 1 = up
+			double mValues[2] = { 0.0, 0.0 };		///< Event specific values, see ELogEvent
+			char mName[logNameSize] = {};			///< Calculator id, truncated
+		};
+
+
+		/**
+		 * Fixed size, lock-free ring buffer of the most recent events, cheap enough to leave on in production.
+		 * Recording claims a slot with a single atomic increment and copies the record into it, old records are overwritten.
+		 * Every slot is guarded by a sequence lock: reading the log never blocks writers, records that are
+		 * overwritten while being read are skipped. Safe to record from multiple threads.
+		 */
+		class NAPAPI EventLog
+		{
+		public:
+			/**
+			 * @param capacity number of records kept, rounded up to a power of 2, 0 disables the log
+			 */
+			EventLog(size_t capacity);
+
+			/**
+			 * Records an event, overwrites the oldest record when full. No-op when disabled.
+			 * @param record the record to store
+			 */
+			void record(const LogRecord& record);
+
+			/**
+			 * Copies the records currently in the log, oldest first.
+			 * @param outRecords receives the records
+			 */
+			void snapshot(std::vector<LogRecord>& outRecords) const;
+
+			/**
+			 * Writes the records currently in the log as text, oldest first, one record per line.
+			 * Doesn't allocate memory itself, can be called from a crash handler.
+			 * @param file the file to write to, for example stderr
+			 */
+			void dump(std::FILE* file) const;
+
+			/**
+			 * Writes the records currently in the log as text to a file.
+			 * @param path the file to write
+			 * @param error contains the error if the file can't be written
+			 * @return if the file is written
+			 */
+			bool dump(const std::string& path, utility::ErrorState& error) const;
+
+			/**
+			 * @return max number of records kept, 0 when disabled
+			 */
+			size_t getCapacity() const						{ return mMask + (mSlots != nullptr ? 1 : 0); }
+
+			/**
+			 * @return total number of records made, including overwritten records
+			 */
+			uint64 getRecordCount() const					{ return mHead.load(std::memory_order_relaxed); }
+
+		private:
+			/**
+			 * Slot in the ring buffer
+			 */
+			struct Slot
+			{
+				std::atomic<uint64> mSequence = { 0 };		///< 2 * ticket + 1 while written, 2 * ticket + 2 when done
+				LogRecord mRecord;
+			};
+
+			/**
+			 * Copies the record with the given ticket, fails when it was overwritten or is being written
+			 */
+			bool read(uint64 ticket, LogRecord& outRecord) const;
+
+			std::unique_ptr<Slot[]> mSlots;					///< Ring buffer, null when disabled
+			size_t mMask = 0;								///< Capacity - 1
+			std::atomic<uint64> mHead = { 0 };				///< Next ticket
+		};
+
+		/**
+		 * @return name of an event
+		 */
+		const char* NAPAPI toString(ELogEvent event);
+	}
+}
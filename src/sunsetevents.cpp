@@ -0,0 +1,292 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetevents.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+
+namespace nap
+{
+	namespace sunset
+	{
+		// Number of locations processed in one go: input and output of a chunk fit in L1 / L2 cache
+		static constexpr size_t chunkSize = 1024;
+
+		// Sun elevation at official sunrise and sunset
+		static constexpr double horizonElevation = 90.0 - Engine::officialZenith;
+
+
+		int toDayNumber(const Day& day)
+		{
+			int y = day.mYear - (day.mMonth <= 2 ? 1 : 0);
+			int era = (y >= 0 ? y : y - 399) / 400;
+			int yoe = y - era * 400;
+			int doy = (153 * (day.mMonth + (day.mMonth > 2 ? -3 : 9)) + 2) / 5 + day.mDay - 1;
+			int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+			return era * 146097 + doe - 719468;
+		}
+
+
+		Day fromDayNumber(int dayNumber)
+		{
+			int z = dayNumber + 719468;
+			int era = (z >= 0 ? z : z - 146096) / 146097;
+			int doe = z - era * 146097;
+			int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+			int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+			int mp = (5 * doy + 2) / 153;
+
+			Day day;
+			day.mDay = doy - (153 * mp + 2) / 5 + 1;
+			day.mMonth = mp < 10 ? mp + 3 : mp - 9;
+			day.mYear = yoe + era * 400 + (day.mMonth <= 2 ? 1 : 0);
+			return day;
+		}
+
+
+		bool isPolarDay(double latitude, double declination)
+		{
+			double noon = 90.0 - std::abs(latitude - declination);
+			double midnight = std::abs(latitude + declination) - 90.0;
+			return noon - horizonElevation > horizonElevation - midnight;
+		}
+
+
+		double getDayLength(const Events& events, double latitude, double declination)
+		{
+			if (std::isnan(events.mSunrise) || std::isnan(events.mSunset))
+				return isPolarDay(latitude, declination) ? 1440.0 : 0.0;
+
+			// Sunset after local midnight ends up before sunrise
+			double length = events.mSunset - events.mSunrise;
+			return length < 0.0 ? length + 1440.0 : length;
+		}
+
+
+		static void computeChunk(const Location* locations, size_t count, const Day& day, Events* outEvents, EEngine engine)
+		{
+			auto model = createEngine(engine);
+			model->setDate(day.mYear, day.mMonth, day.mDay);
+			for (size_t i = 0; i < count; i++)
+			{
+				const auto& location = locations[i];
+				model->setPosition(location.mLatitude, location.mLongitude, location.mTimezone);
+				outEvents[i].mSunrise = model->calcSunrise();
+				outEvents[i].mSunset = model->calcSunset();
+			}
+		}
+
+
+		/**
+		 * Worker threads shared by all parallel computations, started on first use and added on demand.
+		 */
+		class WorkerPool
+		{
+		public:
+			/**
+			 * Runs a job once on 'count' workers, starts workers when there are fewer.
+			 */
+			void post(size_t count, const std::function<void()>& job)
+			{
+				{
+					std::lock_guard<std::mutex> lock(mMutex);
+					while (mWorkers.size() < count)
+						mWorkers.emplace_back([this]() { run(); });
+					for (size_t i = 0; i < count; i++)
+						mJobs.emplace_back(job);
+				}
+				mCondition.notify_all();
+			}
+
+		private:
+			void run()
+			{
+				while (true)
+				{
+					std::function<void()> job;
+					{
+						std::unique_lock<std::mutex> lock(mMutex);
+						mCondition.wait(lock, [this]() { return !mJobs.empty(); });
+						job = std::move(mJobs.front());
+						mJobs.pop_front();
+					}
+					job();
+				}
+			}
+
+			std::mutex mMutex;									///< Guards the workers and jobs
+			std::condition_variable mCondition;					///< Signals new jobs
+			std::deque<std::function<void()>> mJobs;			///< Jobs not picked up by a worker yet
+			std::vector<std::thread> mWorkers;					///< All workers, they never stop
+		};
+
+
+		/**
+		 * The pool is never destroyed: joining threads while the module unloads can deadlock.
+		 */
+		static WorkerPool& getWorkerPool()
+		{
+			static WorkerPool* pool = new WorkerPool();
+			return *pool;
+		}
+
+
+		/**
+		 * Tasks of a single parallelFor() call, shared with the workers that help out.
+		 * Workers that pick up the batch after all tasks are claimed leave without touching the task.
+		 */
+		struct TaskBatch
+		{
+			TaskBatch(size_t count, const std::function<void(size_t)>& task) :
+				mCount(count), mTask(task)						{ }
+
+			// Claims tasks until all of them are claimed
+			void work()
+			{
+				size_t index;
+				while ((index = mNext.fetch_add(1)) < mCount)
+					mTask(index);
+			}
+
+			// Called by a worker
+			void help()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mMutex);
+					if (mDone)
+						return;
+					mRunning++;
+				}
+				work();
+
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (--mRunning == 0)
+					mCondition.notify_all();
+			}
+
+			// Called by the calling thread after its own work: waits for the workers that are still processing a task
+			void finish()
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mDone = true;
+				mCondition.wait(lock, [this]() { return mRunning == 0; });
+			}
+
+			size_t mCount = 0;
+			const std::function<void(size_t)>& mTask;
+			std::atomic<size_t> mNext = { 0 };
+			std::mutex mMutex;
+			std::condition_variable mCondition;
+			int mRunning = 0;
+			bool mDone = false;
+		};
+
+
+		void parallelFor(size_t count, int threadCount, const std::function<void(size_t)>& task)
+		{
+			// Resolve number of threads, never more than there are tasks
+			size_t thread_count = threadCount > 0 ? static_cast<size_t>(threadCount) :
+				std::max<size_t>(std::thread::hardware_concurrency(), 1);
+			thread_count = std::min(thread_count, count);
+
+			// Compute on calling thread
+			if (thread_count <= 1)
+			{
+				for (size_t i = 0; i < count; i++)
+					task(i);
+				return;
+			}
+
+			// Workers of the pool claim tasks until all of them are processed, calling thread participates
+			auto batch = std::make_shared<TaskBatch>(count, task);
+			getWorkerPool().post(thread_count - 1, [batch]() { batch->help(); });
+			batch->work();
+			batch->finish();
+		}
+
+
+		void computeEvents(const Location* locations, size_t count, const Day& day, Events* outEvents, int threadCount, EEngine engine)
+		{
+			size_t chunk_count = (count + chunkSize - 1) / chunkSize;
+			parallelFor(chunk_count, threadCount, [&](size_t chunk)
+			{
+				size_t first = chunk * chunkSize;
+				computeChunk(locations + first, std::min(chunkSize, count - first), day, outEvents + first, engine);
+			});
+		}
+
+
+		void computeEvents(const std::vector<Location>& locations, const Day& day, std::vector<Events>& outEvents, int threadCount, EEngine engine)
+		{
+			outEvents.resize(locations.size());
+			computeEvents(locations.data(), locations.size(), day, outEvents.data(), threadCount, engine);
+		}
+	
+
+		EventCache::EventCache(size_t capacity) :
+			mCapacity(std::max<size_t>(capacity, 1))
+		{ }
+
+
+		bool EventCache::find(int dayNumber, Events& outEvents)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			auto it = mIndex.find(dayNumber);
+			if (it == mIndex.end())
+				return false;
+
+			mEntries.splice(mEntries.begin(), mEntries, it->second);
+			outEvents = it->second->second;
+			return true;
+		}
+
+
+		void EventCache::insert(int dayNumber, const Events& events, int generation)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (generation != mGeneration)
+				return;
+
+			// Update existing
+			auto it = mIndex.find(dayNumber);
+			if (it != mIndex.end())
+			{
+				it->second->second = events;
+				mEntries.splice(mEntries.begin(), mEntries, it->second);
+				return;
+			}
+
+			// Evict least recently used
+			if (mEntries.size() >= mCapacity)
+			{
+				mIndex.erase(mEntries.back().first);
+				mEntries.pop_back();
+			}
+			mEntries.emplace_front(dayNumber, events);
+			mIndex.emplace(dayNumber, mEntries.begin());
+		}
+
+
+		void EventCache::clear()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mEntries.clear();
+			mIndex.clear();
+			mGeneration++;
+		}
+
+
+		int EventCache::getGeneration()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mGeneration;
+		}
+	}
+}
@@ -0,0 +1,172 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "sunsetengine.h"
+
+#include <utility/dllexport.h>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Geographic location of a site.
+		 */
+		struct Location
+		{
+			double mLatitude = 0.0;				///< Latitude in degrees
+			double mLongitude = 0.0;			///< Longitude in degrees
+			double mTimezone = 0.0;				///< Timezone offset in hours
+		};
+
+		/**
+		 * Calendar day.
+		 */
+		struct Day
+		{
+			int mYear = 1970;					///< Year, 4 digits
+			int mMonth = 1;						///< Month, 1 = January
+			int mDay = 1;						///< Day of the month, starts at 1
+		};
+
+		/**
+		 * Sunrise and sunset of a single day, in minutes past local midnight.
+		 * NaN when the sun doesn't rise or set on that day (polar day or night).
+		 */
+		struct Events
+		{
+			double mSunrise = 0.0;				///< Sunrise in minutes past local midnight
+			double mSunset = 0.0;				///< Sunset in minutes past local midnight
+		};
+
+		/**
+		 * @param day calendar day
+		 * @return number of days since 1970-01-01
+		 */
+		int NAPAPI toDayNumber(const Day& day);
+
+		/**
+		 * @param dayNumber number of days since 1970-01-01
+		 * @return calendar day
+		 */
+		Day NAPAPI fromDayNumber(int dayNumber);
+
+		/**
+		 * Tells if a day without official sunrise or sunset is part of the polar day or the polar night,
+		 * whichever the sun is closest to at its highest and lowest elevation of the day.
+		 * @param latitude latitude in degrees
+		 * @param declination solar declination at noon in degrees
+		 * @return if the sun stays up all day
+		 */
+		bool NAPAPI isPolarDay(double latitude, double declination);
+
+		/**
+		 * Minutes of daylight of a day. A sunset after local midnight, which ends up before sunrise, wraps around.
+		 * Days without official sunrise or sunset count as 1440 (polar day) or 0 (polar night) minutes, see isPolarDay().
+		 * @param events sunrise and sunset of the day
+		 * @param latitude latitude in degrees
+		 * @param declination solar declination at noon in degrees, only used when the sun doesn't rise or set
+		 * @return minutes of daylight, 0 to 1440
+		 */
+		double NAPAPI getDayLength(const Events& events, double latitude, double declination);
+
+		/**
+		 * Calls 'task' once for every index in [0, count), spread over 'threadCount' threads.
+		 * The threads come from a worker pool shared by all calls, which is started on first use and keeps its threads.
+		 * Threads claim the next index until all of them are processed, the calling thread participates.
+		 * Returns when all tasks are done. Calls may be nested, a worker never waits for another to start.
+		 * @param count number of tasks
+		 * @param threadCount number of threads to use, 0 uses all available cores. Never more than 'count'
+		 * @param task called with the index of the task, from multiple threads at once
+		 */
+		void NAPAPI parallelFor(size_t count, int threadCount, const std::function<void(size_t)>& task);
+
+		/**
+		 * Computes sunrise and sunset for a range of locations on the given day.
+		 * The input is split into cache sized chunks that are processed in parallel.
+		 * Small inputs are processed on the calling thread.
+		 * @param locations locations to compute the events for
+		 * @param count number of locations and events
+		 * @param day the day to compute the events for
+		 * @param outEvents receives the events of every location, must hold 'count' elements
+		 * @param threadCount number of threads to use, 0 uses all available cores
+		 * @param engine the engine used to compute the events
+		 */
+		void NAPAPI computeEvents(const Location* locations, size_t count, const Day& day, Events* outEvents, int threadCount = 0, EEngine engine = EEngine::NOAA);
+
+		/**
+		 * Computes sunrise and sunset for all locations on the given day.
+		 * The input is split into cache sized chunks that are processed in parallel.
+		 * @param locations locations to compute the events for
+		 * @param day the day to compute the events for
+		 * @param outEvents receives the events of every location, resized to match the number of locations
+		 * @param threadCount number of threads to use, 0 uses all available cores
+		 * @param engine the engine used to compute the events
+		 */
+		void NAPAPI computeEvents(const std::vector<Location>& locations, const Day& day, std::vector<Events>& outEvents, int threadCount = 0, EEngine engine = EEngine::NOAA);
+	
+
+		/**
+		 * Bounded least recently used cache of events by day number, thread safe.
+		 * Clearing the cache starts a new generation: results computed for a previous generation are not inserted.
+		 */
+		class NAPAPI EventCache
+		{
+		public:
+			/**
+			 * @param capacity max number of days in the cache
+			 */
+			EventCache(size_t capacity);
+
+			/**
+			 * Finds the events of a day and marks it as most recently used.
+			 * @param dayNumber number of days since 1970-01-01
+			 * @param outEvents receives the events when cached
+			 * @return if the day is cached
+			 */
+			bool find(int dayNumber, Events& outEvents);
+
+			/**
+			 * Inserts the events of a day, evicts the least recently used day when full.
+			 * Ignored when the cache was cleared after 'generation' was retrieved.
+			 * @param dayNumber number of days since 1970-01-01
+			 * @param events the events of the day
+			 * @param generation generation the events were computed for
+			 */
+			void insert(int dayNumber, const Events& events, int generation);
+
+			/**
+			 * Removes all days and starts a new generation.
+			 */
+			void clear();
+
+			/**
+			 * @return current generation, pass it to insert()
+			 */
+			int getGeneration();
+
+			/**
+			 * @return max number of days in the cache
+			 */
+			size_t getCapacity() const						{ return mCapacity; }
+
+		private:
+			using Entry = std::pair<int, Events>;
+
+			size_t mCapacity = 0;									///< Max number of days
+			int mGeneration = 0;									///< Incremented on clear
+			std::list<Entry> mEntries;								///< Most recently used first
+			std::unordered_map<int, std::list<Entry>::iterator> mIndex;	///< Day number to entry
+			std::mutex mMutex;										///< Guards all of the above
+		};
+	}
+}
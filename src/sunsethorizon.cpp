@@ -0,0 +1,210 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsethorizon.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nap
+{
+	namespace sunset
+	{
+		static constexpr double pi = 3.14159265358979323846;
+		static constexpr double degToRad = pi / 180.0;
+		static constexpr double radToDeg = 180.0 / pi;
+
+		// Refraction and radius of the sun at the horizon, as in the official sunrise & sunset
+		static constexpr double horizonCorrection = 0.833;
+
+		// Scan step in minutes, obstructions narrower than this might be skipped
+		static constexpr double scanStep = 5.0;
+
+		// Margin in minutes around the window the sun is above the lowest point of the mask
+		static constexpr double windowMargin = 10.0;
+
+		// Crossing tolerance in minutes
+		static constexpr double tolerance = 1.0 / 600.0;
+		static constexpr int maxIterations = 40;
+
+
+		double HorizonMask::getElevation(double azimuth) const
+		{
+			if (mElevations.empty())
+				return 0.0;
+
+			double count = static_cast<double>(mElevations.size());
+			double position = std::fmod(azimuth, 360.0) / 360.0 * count;
+			if (position < 0.0)
+				position += count;
+
+			size_t index = static_cast<size_t>(position) % mElevations.size();
+			size_t next = (index + 1) % mElevations.size();
+			double fraction = position - std::floor(position);
+			return mElevations[index] + (mElevations[next] - mElevations[index]) * fraction;
+		}
+
+
+		double HorizonMask::getMinElevation() const
+		{
+			return mElevations.empty() ? 0.0 : *std::min_element(mElevations.begin(), mElevations.end());
+		}
+
+
+		void calcSolarPosition(const SolarTerms& terms, double minutes, double& outElevation, double& outAzimuth)
+		{
+			// Interpolate terms quadratically over midnight, noon and next midnight
+			double f = std::min(std::max(minutes / 1440.0, 0.0), 1.0);
+			double w0 = (2.0 * f - 1.0) * (f - 1.0);
+			double w1 = 4.0 * f * (1.0 - f);
+			double w2 = f * (2.0 * f - 1.0);
+			double declination = (terms.mDeclination[0] * w0 + terms.mDeclination[1] * w1 + terms.mDeclination[2] * w2) * degToRad;
+			double eq_time = terms.mEquationOfTime[0] * w0 + terms.mEquationOfTime[1] * w1 + terms.mEquationOfTime[2] * w2;
+
+			// Hour angle from true solar time
+			double solar_time = minutes + eq_time + 4.0 * terms.mLongitude - 60.0 * terms.mTimezone;
+			double hour_angle = (solar_time / 4.0 - 180.0) * degToRad;
+
+			double lat = terms.mLatitude * degToRad;
+			double sin_elevation = std::sin(lat) * std::sin(declination) + std::cos(lat) * std::cos(declination) * std::cos(hour_angle);
+			outElevation = std::asin(std::min(std::max(sin_elevation, -1.0), 1.0)) * radToDeg;
+
+			// Azimuth from south westward, converted to north eastward
+			double azimuth = std::atan2(std::sin(hour_angle), std::cos(hour_angle) * std::sin(lat) - std::tan(declination) * std::cos(lat));
+			outAzimuth = std::fmod(azimuth * radToDeg + 540.0, 360.0);
+		}
+
+
+		/**
+		 * Refines a bracketed crossing using the Illinois variant of regula falsi.
+		 * @param fn clearance of the sun over the mask
+		 * @param a time below the mask
+		 * @param b time above the mask
+		 */
+		template<typename F>
+		static double refine(const F& fn, double a, double fa, double b, double fb)
+		{
+			int side = 0;
+			for (int i = 0; i < maxIterations && std::abs(b - a) > tolerance; i++)
+			{
+				double c = (a * fb - b * fa) / (fb - fa);
+				double fc = fn(c);
+				if ((fc >= 0.0) == (fb >= 0.0))
+				{
+					b = c; fb = fc;
+					if (side == 1)
+						fa *= 0.5;
+					side = 1;
+				}
+				else
+				{
+					a = c; fa = fc;
+					if (side == -1)
+						fb *= 0.5;
+					side = -1;
+				}
+			}
+			return (a * fb - b * fa) / (fb - fa);
+		}
+
+
+		/**
+		 * Scans from a time the sun clears the mask towards 'limit' until it doesn't, and refines the crossing.
+		 * @param fn clearance of the sun over the mask
+		 * @param t time above the mask
+		 * @param step scan step in minutes, negative to scan backward
+		 * @param limit time the scan stops at
+		 * @return the crossing, NaN when the sun clears the mask up to 'limit'
+		 */
+		template<typename F>
+		static double scanBelow(const F& fn, double t, double ft, double step, double limit)
+		{
+			while (t != limit)
+			{
+				double next = step > 0.0 ? std::min(t + step, limit) : std::max(t + step, limit);
+				double fnext = fn(next);
+				if (fnext < 0.0)
+					return refine(fn, next, fnext, t, ft);
+				t = next; ft = fnext;
+			}
+			return NAN;
+		}
+
+
+		bool calcHorizonCrossings(const SolarTerms& terms, const HorizonMask& mask, double& outSunrise, double& outSunset)
+		{
+			outSunrise = outSunset = NAN;
+			auto clearance = [&terms, &mask](double minutes)
+			{
+				double elevation, azimuth;
+				calcSolarPosition(terms, minutes, elevation, azimuth);
+				return elevation + horizonCorrection - mask.getElevation(azimuth);
+			};
+
+			// Window the sun is above the lowest point of the mask, using the terms at noon
+			double lat = terms.mLatitude * degToRad;
+			double declination = terms.mDeclination[1] * degToRad;
+			double cos_ha = (std::sin((mask.getMinElevation() - horizonCorrection) * degToRad) - std::sin(lat) * std::sin(declination)) /
+				(std::cos(lat) * std::cos(declination));
+			if (cos_ha > 1.0)
+				return false;
+
+			double begin = 0.0, end = 1440.0;
+			if (cos_ha >= -1.0)
+			{
+				double half_day = 4.0 * std::acos(cos_ha) * radToDeg;
+				double noon = 720.0 - 4.0 * terms.mLongitude - terms.mEquationOfTime[1] + 60.0 * terms.mTimezone;
+				begin = std::max(noon - half_day - windowMargin, 0.0);
+				end = std::min(noon + half_day + windowMargin, 1440.0);
+			}
+
+			// Sunrise: scan forward until the sun clears the mask
+			// The window is estimated from the terms at noon and can cut off a grazing crossing, extend it towards midnight
+			double t0 = begin, f0 = clearance(begin);
+			if (f0 >= 0.0)
+			{
+				double crossing = scanBelow(clearance, begin, f0, -scanStep, 0.0);
+				outSunrise = std::isnan(crossing) ? -INFINITY : crossing;
+			}
+			else
+			{
+				while (t0 < end)
+				{
+					double t1 = std::min(t0 + scanStep, end);
+					double f1 = clearance(t1);
+					if (f1 >= 0.0)
+					{
+						outSunrise = refine(clearance, t0, f0, t1, f1);
+						break;
+					}
+					t0 = t1; f0 = f1;
+				}
+				if (std::isnan(outSunrise))
+					return false;
+			}
+
+			// Sunset: scan backward until the sun clears the mask
+			t0 = end, f0 = clearance(end);
+			if (f0 >= 0.0)
+			{
+				double crossing = scanBelow(clearance, end, f0, scanStep, 1440.0);
+				outSunset = std::isnan(crossing) ? INFINITY : crossing;
+				return true;
+			}
+
+			while (t0 > begin)
+			{
+				double t1 = std::max(t0 - scanStep, begin);
+				double f1 = clearance(t1);
+				if (f1 >= 0.0)
+				{
+					outSunset = refine(clearance, t0, f0, t1, f1);
+					break;
+				}
+				t0 = t1; f0 = f1;
+			}
+			return true;
+		}
+	}
+}
@@ -0,0 +1,84 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <utility/dllexport.h>
+#include <vector>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Elevation of the local horizon by azimuth, for example terrain or buildings.
+		 * Samples are evenly spaced over the full circle, starting north and going clockwise (east).
+		 * An empty mask is the flat horizon.
+		 */
+		struct NAPAPI HorizonMask
+		{
+			std::vector<double> mElevations;		///< Horizon elevation in degrees, evenly spaced by azimuth
+
+			/**
+			 * @param azimuth azimuth in degrees, 0 = north, 90 = east
+			 * @return horizon elevation in degrees, linearly interpolated between samples
+			 */
+			double getElevation(double azimuth) const;
+
+			/**
+			 * @return lowest horizon elevation in degrees
+			 */
+			double getMinElevation() const;
+		};
+
+
+		/**
+		 * Solar terms of a location on a single day, computed once by the engine.
+		 * Declination and equation of time are sampled at local midnight, noon and the next midnight, and interpolated quadratically.
+		 */
+		struct SolarTerms
+		{
+			static constexpr int sampleCount = 3;
+			double mLatitude = 0.0;							///< Latitude in degrees
+			double mLongitude = 0.0;						///< Longitude in degrees
+			double mTimezone = 0.0;							///< Timezone offset in hours
+			double mDeclination[sampleCount] = {};			///< Solar declination in degrees
+			double mEquationOfTime[sampleCount] = {};		///< Equation of time in minutes
+		};
+
+
+		/**
+		 * Computes the geometric position of the sun, without refraction.
+		 * @param terms solar terms of the day
+		 * @param minutes local time in minutes past midnight
+		 * @param outElevation receives the sun elevation in degrees
+		 * @param outAzimuth receives the sun azimuth in degrees, 0 = north, 90 = east
+		 */
+		void NAPAPI calcSolarPosition(const SolarTerms& terms, double minutes, double& outElevation, double& outAzimuth);
+
+		/**
+		 * Computes when the sun rises above and sets below a horizon mask.
+		 * The search only scans the part of the day the sun is above the lowest point of the mask,
+		 * in coarse steps from either end until the sun clears the mask, and refines the bracketed crossing.
+		 * That window is estimated from the terms at noon: when the sun already clears the mask at its edge,
+		 * the scan continues towards midnight. Refraction and the sun's radius are accounted for as in the
+		 * official sunrise and sunset.
+		 *
+		 * With the NOAA engine and a constant mask the crossings are within 0.003 seconds of the crossing solved
+		 * with the exact terms at that time, up to 72 degrees latitude. calcCustomSunrise() and calcCustomSunset()
+		 * refine only once: they differ up to 2.2 seconds up to 60 degrees latitude, and a minute or more at grazing
+		 * crossings, where the sun only just clears the mask. The Precise engine is matched within 0.3 seconds up to
+		 * 60 degrees latitude; at grazing crossings the time above the mask is so sensitive to the sun position
+		 * that its own model differs by minutes.
+		 * @param terms solar terms of the day
+		 * @param mask horizon mask
+		 * @param outSunrise receives the first time the sun clears the mask, in minutes past local midnight.
+		 * -INFINITY when the sun already clears the mask at local midnight, NaN when it doesn't clear the mask
+		 * @param outSunset receives the last time the sun clears the mask, in minutes past local midnight.
+		 * INFINITY when the sun still clears the mask at the next local midnight, NaN when it doesn't clear the mask
+		 * @return if the sun clears the mask
+		 */
+		bool NAPAPI calcHorizonCrossings(const SolarTerms& terms, const HorizonMask& mask, double& outSunrise, double& outSunset);
+	}
+}
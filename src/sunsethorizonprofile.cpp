@@ -0,0 +1,46 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsethorizonprofile.h"
+
+#include <utility/fileutils.h>
+#include <algorithm>
+#include <sstream>
+
+RTTI_BEGIN_CLASS(nap::HorizonProfile)
+	RTTI_PROPERTY("Elevations", &nap::HorizonProfile::mElevations, nap::rtti::EPropertyMetaData::Default, "Horizon elevation in degrees, evenly spaced by azimuth starting north")
+	RTTI_PROPERTY_FILELINK("Path", &nap::HorizonProfile::mPath, nap::rtti::EPropertyMetaData::Default, nap::rtti::EPropertyFileType::Any, "Optional file to read the elevations from")
+RTTI_END_CLASS
+
+namespace nap
+{
+	bool HorizonProfile::init(utility::ErrorState& errorState)
+	{
+		mMask.mElevations = mElevations;
+		if (!mPath.empty())
+		{
+			std::string buffer;
+			if (!utility::readFileToString(mPath, buffer, errorState))
+				return false;
+
+			// Elevations separated by white space or commas
+			std::replace(buffer.begin(), buffer.end(), ',', ' ');
+			std::istringstream stream(buffer);
+			mMask.mElevations.clear();
+			double elevation;
+			while (stream >> elevation)
+				mMask.mElevations.emplace_back(elevation);
+
+			if (!errorState.check(stream.eof(), "%s: invalid elevation in: %s", mID.c_str(), mPath.c_str()))
+				return false;
+		}
+
+		for (auto elevation : mMask.mElevations)
+		{
+			if (!errorState.check(elevation >= -90.0 && elevation <= 90.0, "%s: horizon elevation out of range: %f", mID.c_str(), elevation))
+				return false;
+		}
+		return true;
+	}
+}
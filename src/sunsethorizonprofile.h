@@ -0,0 +1,43 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <nap/resource.h>
+
+#include "sunsethorizon.h"
+
+namespace nap
+{
+	/**
+	 * Elevation of the local horizon by azimuth, for example surrounding terrain or buildings.
+	 * Samples are evenly spaced over the full circle, starting north and going clockwise (east).
+	 * Assign it to a nap::SunsetCalculatorComponent to get local instead of astronomical sunrise and sunset.
+	 *
+	 * Elevations are read from 'Path' when set: a text file with one elevation per sample,
+	 * separated by white space, commas or new lines. Otherwise 'Elevations' is used.
+	 */
+	class NAPAPI HorizonProfile : public Resource
+	{
+		RTTI_ENABLE(Resource)
+	public:
+		std::vector<double> mElevations;			///< Property: 'Elevations' horizon elevation in degrees, evenly spaced by azimuth starting north
+		std::string mPath;							///< Property: 'Path' optional file to read the elevations from
+
+		/**
+		 * Reads and validates the elevations.
+		 * @param errorState contains the error if the profile is invalid
+		 * @return if the profile is valid
+		 */
+		virtual bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * @return the horizon mask
+		 */
+		const sunset::HorizonMask& getMask() const	{ return mMask; }
+
+	private:
+		sunset::HorizonMask mMask;
+	};
+}
@@ -0,0 +1,170 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetpowercomponent.h"
+
+#include <entity.h>
+#include <nap/datetime.h>
+#include <algorithm>
+#include <thread>
+
+RTTI_BEGIN_ENUM(nap::ENightPhase)
+	RTTI_ENUM_VALUE(nap::ENightPhase::SunDown,				"SunDown"),
+	RTTI_ENUM_VALUE(nap::ENightPhase::CivilTwilight,		"CivilTwilight"),
+	RTTI_ENUM_VALUE(nap::ENightPhase::NauticalTwilight,		"NauticalTwilight"),
+	RTTI_ENUM_VALUE(nap::ENightPhase::AstronomicalTwilight,	"AstronomicalTwilight")
+RTTI_END_ENUM
+
+RTTI_BEGIN_STRUCT(nap::PowerProfile)
+	RTTI_PROPERTY("Framerate", &nap::PowerProfile::mFramerate, nap::rtti::EPropertyMetaData::Default, "Max number of updates per second, 0 is unlimited")
+	RTTI_PROPERTY("SuspendGui", &nap::PowerProfile::mSuspendGui, nap::rtti::EPropertyMetaData::Default, "If the GUI is hidden")
+RTTI_END_STRUCT
+
+RTTI_BEGIN_CLASS(nap::SunsetPowerComponent)
+	RTTI_PROPERTY("Calculator", &nap::SunsetPowerComponent::mCalculator, nap::rtti::EPropertyMetaData::Required, "Calculator that provides the sun state and position")
+	RTTI_PROPERTY("NightPhase", &nap::SunsetPowerComponent::mNightPhase, nap::rtti::EPropertyMetaData::Default, "Sun position at which the night profile starts: SunDown, CivilTwilight, NauticalTwilight or AstronomicalTwilight")
+	RTTI_PROPERTY("Hysteresis", &nap::SunsetPowerComponent::mHysteresis, nap::rtti::EPropertyMetaData::Default, "Elevation band in degrees around a twilight phase in which the profile doesn't switch")
+	RTTI_PROPERTY("HoldTime", &nap::SunsetPowerComponent::mHoldTime, nap::rtti::EPropertyMetaData::Default, "Seconds a new phase has to hold before the profile switches")
+	RTTI_PROPERTY("Day", &nap::SunsetPowerComponent::mDay, nap::rtti::EPropertyMetaData::Default, "Profile applied during the day")
+	RTTI_PROPERTY("Night", &nap::SunsetPowerComponent::mNight, nap::rtti::EPropertyMetaData::Default, "Profile applied during the night")
+	RTTI_PROPERTY("FullFramerate", &nap::SunsetPowerComponent::mFullFramerate, nap::rtti::EPropertyMetaData::Default, "Framerate of the display when rendering every frame, the reference for savings")
+	RTTI_PROPERTY("FullPower", &nap::SunsetPowerComponent::mFullPower, nap::rtti::EPropertyMetaData::Default, "Watts drawn when rendering at the full framerate")
+	RTTI_PROPERTY("IdlePower", &nap::SunsetPowerComponent::mIdlePower, nap::rtti::EPropertyMetaData::Default, "Watts drawn when not rendering")
+RTTI_END_CLASS
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::SunsetPowerComponentInstance)
+	RTTI_CONSTRUCTOR(nap::EntityInstance&, nap::Component&)
+RTTI_END_CLASS
+
+namespace nap
+{
+	// Sun elevation in degrees at which every night phase starts, sunset is handled by the calculator
+	static constexpr double phaseElevations[] = { 0.0, -6.0, -12.0, -18.0 };
+
+
+	void SunsetPowerComponent::getDependentComponents(std::vector<rtti::TypeInfo>& components) const
+	{
+		components.emplace_back(RTTI_OF(SunsetCalculatorComponent));
+	}
+
+
+	/**
+	 * @return if the profile is valid
+	 */
+	static bool checkProfile(const PowerProfile& profile, const std::string& id, const char* name, utility::ErrorState& error)
+	{
+		return error.check(profile.mFramerate >= 0.0f, "%s: %s framerate can't be negative: %f", id.c_str(), name, profile.mFramerate);
+	}
+
+
+	bool SunsetPowerComponentInstance::init(utility::ErrorState& errorState)
+	{
+		auto* resource = getComponent<SunsetPowerComponent>();
+		if (!checkProfile(resource->mDay, mID, "day", errorState) || !checkProfile(resource->mNight, mID, "night", errorState))
+			return false;
+
+		if (!errorState.check(resource->mHysteresis >= 0.0f && resource->mHoldTime >= 0.0f, "%s: hysteresis and hold time can't be negative", mID.c_str()))
+			return false;
+
+		if (!errorState.check(resource->mFullFramerate > 0.0f, "%s: full framerate must be positive: %f", mID.c_str(), resource->mFullFramerate))
+			return false;
+
+		if (!errorState.check(resource->mFullPower >= resource->mIdlePower, "%s: full power is lower than idle power", mID.c_str()))
+			return false;
+
+		mDayProfile = resource->mDay;
+		mNightProfile = resource->mNight;
+		mNightPhase = resource->mNightPhase;
+		mElevation = phaseElevations[static_cast<int>(mNightPhase)];
+		mHysteresis = resource->mHysteresis;
+		mHoldTime = resource->mHoldTime;
+		mFullFramerate = resource->mFullFramerate;
+		mFullPower = resource->mFullPower;
+		mIdlePower = resource->mIdlePower;
+
+		// Apply the current phase without hysteresis or hold time
+		mHysteresis = 0.0;
+		mNight = getPhase();
+		mHysteresis = resource->mHysteresis;
+		mNextFrame = std::chrono::steady_clock::now();
+		return true;
+	}
+
+
+	void SunsetPowerComponentInstance::update(double deltaTime)
+	{
+		// Switch when the new phase held long enough
+		bool night = getPhase();
+		mPendingTime = night != mNight ? mPendingTime + deltaTime : 0.0;
+		if (mPendingTime >= mHoldTime && night != mNight)
+		{
+			mNight = night;
+			mPendingTime = 0.0;
+			mCounters.mSwitches++;
+			mProfileChanged(mNight);
+		}
+		(mNight ? mCounters.mNightTime : mCounters.mDayTime) += deltaTime;
+		mCounters.mRenderedFrames++;
+
+		throttle();
+	}
+
+
+	double SunsetPowerComponentInstance::getTimeSaved() const
+	{
+		// Time it would have taken to render at the full framerate, minus the frames that were rendered
+		double time = mCounters.mDayTime + mCounters.mNightTime;
+		return std::max(time - static_cast<double>(mCounters.mRenderedFrames) / mFullFramerate, 0.0);
+	}
+
+
+	double SunsetPowerComponentInstance::getEnergySaved() const
+	{
+		return (mFullPower - mIdlePower) * getTimeSaved();
+	}
+
+
+	bool SunsetPowerComponentInstance::getPhase() const
+	{
+		// Calculator state, the offsets are applied by the calculator
+		if (mNightPhase == ENightPhase::SunDown)
+		{
+			auto state = mCalculator->getState();
+			return state == SunsetCalculatorComponentInstance::EState::Unknown ? mNight :
+				state == SunsetCalculatorComponentInstance::EState::Down;
+		}
+
+		// Sun elevation, the phase doesn't change within the hysteresis band
+		double elevation, azimuth;
+		mCalculator->getSunPosition(getCurrentTime(), elevation, azimuth);
+		double half_band = 0.5 * mHysteresis;
+		if (elevation < mElevation - half_band)
+			return true;
+		if (elevation > mElevation + half_band)
+			return false;
+		return mHysteresis > 0.0 ? mNight : elevation < mElevation;
+	}
+
+
+	void SunsetPowerComponentInstance::throttle()
+	{
+		auto now = std::chrono::steady_clock::now();
+		float framerate = getProfile().mFramerate;
+		if (framerate <= 0.0f)
+		{
+			mNextFrame = now;
+			return;
+		}
+
+		// Sleep until the frame is due, don't catch up on frames that took longer
+		if (mNextFrame > now)
+		{
+			std::this_thread::sleep_until(mNextFrame);
+			mCounters.mSleepTime += std::chrono::duration<double>(mNextFrame - now).count();
+			now = mNextFrame;
+		}
+		auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / framerate));
+		mNextFrame = std::max(mNextFrame + interval, now);
+	}
+}
@@ -0,0 +1,186 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <component.h>
+#include <componentptr.h>
+#include <nap/signalslot.h>
+
+#include "sunsetcalculatorcomponent.h"
+
+#include <chrono>
+
+namespace nap
+{
+	class SunsetPowerComponentInstance;
+
+	/**
+	 * Sun position at which the night profile starts.
+	 */
+	enum class ENightPhase : int
+	{
+		SunDown					= 0,	///< Sunset of the calculator, including offsets
+		CivilTwilight			= 1,	///< Sun 6 degrees below the horizon
+		NauticalTwilight		= 2,	///< Sun 12 degrees below the horizon
+		AstronomicalTwilight	= 3		///< Sun 18 degrees below the horizon
+	};
+
+
+	/**
+	 * How an app renders during the day or night.
+	 */
+	struct NAPAPI PowerProfile
+	{
+		float mFramerate = 0.0f;			///< Property: 'Framerate' max number of updates per second, 0 is unlimited
+		bool mSuspendGui = false;			///< Property: 'SuspendGui' if the GUI is hidden
+	};
+
+
+	/**
+	 * Power consumption counters of a nap::SunsetPowerComponent.
+	 */
+	struct PowerCounters
+	{
+		double mDayTime = 0.0;				///< Seconds spent in the day profile
+		double mNightTime = 0.0;			///< Seconds spent in the night profile
+		double mSleepTime = 0.0;			///< Seconds slept to limit the framerate
+		uint64 mRenderedFrames = 0;			///< Number of frames rendered, one per update
+		int mSwitches = 0;					///< Number of switches between the day and night profile
+	};
+
+
+	/**
+	 * Applies a day or night power profile to the app, based on the sun state or twilight phase of a calculator.
+	 * Displays that don't need to render at full rate at night can lower their framerate or hide the GUI.
+	 * The component limits the framerate by sleeping on update, the app queries isGuiSuspended().
+	 *
+	 * Switches are protected against flicker: with a twilight phase the sun has to move 'Hysteresis' / 2 degrees
+	 * past the phase elevation, and a new phase has to hold for 'HoldTime' seconds before the profile switches.
+	 *
+	 * Saved time and energy are estimated against rendering every frame at 'FullFramerate', assuming the app
+	 * draws 'IdlePower' watts when it doesn't render and 'FullPower' watts when it renders at the full framerate.
+	 */
+	class NAPAPI SunsetPowerComponent : public Component
+	{
+		RTTI_ENABLE(Component)
+		DECLARE_COMPONENT(SunsetPowerComponent, SunsetPowerComponentInstance)
+	public:
+		ComponentPtr<SunsetCalculatorComponent> mCalculator;	///< Property: 'Calculator' calculator that provides the sun state and position
+		ENightPhase mNightPhase = ENightPhase::SunDown;			///< Property: 'NightPhase' sun position at which the night profile starts
+		float mHysteresis = 1.0f;								///< Property: 'Hysteresis' elevation band in degrees around a twilight phase in which the profile doesn't switch
+		float mHoldTime = 60.0f;								///< Property: 'HoldTime' seconds a new phase has to hold before the profile switches
+		PowerProfile mDay;										///< Property: 'Day' profile applied during the day
+		PowerProfile mNight = { 5.0f, true };				///< Property: 'Night' profile applied during the night
+		float mFullFramerate = 60.0f;							///< Property: 'FullFramerate' framerate of the display when rendering every frame, the reference for savings
+		float mFullPower = 100.0f;								///< Property: 'FullPower' watts drawn when rendering at the full framerate
+		float mIdlePower = 20.0f;								///< Property: 'IdlePower' watts drawn when not rendering
+
+		/**
+		 * The calculator is initialized first, it provides the sun state.
+		 */
+		virtual void getDependentComponents(std::vector<rtti::TypeInfo>& components) const override;
+	};
+
+
+	/**
+	 * Applies the day or night profile, see nap::SunsetPowerComponent.
+	 * Skip building the GUI in update() when isGuiSuspended() returns true, but keep drawing the GUI frame.
+	 */
+	class NAPAPI SunsetPowerComponentInstance : public ComponentInstance
+	{
+		RTTI_ENABLE(ComponentInstance)
+	public:
+		SunsetPowerComponentInstance(EntityInstance& entity, Component& resource) :
+			ComponentInstance(entity, resource)									{ }
+
+		/**
+		 * Resolves the current phase and applies its profile immediately.
+		 * @param errorState contains the error if the settings are invalid
+		 * @return if initialization succeeded
+		 */
+		virtual bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Switches the profile when the phase changed and held, updates counters and sleeps to limit the framerate.
+		 * @param deltaTime time in between frames in seconds
+		 */
+		virtual void update(double deltaTime) override;
+
+		/**
+		 * @return if the GUI should be hidden
+		 */
+		bool isGuiSuspended() const							{ return getProfile().mSuspendGui; }
+
+		/**
+		 * @return max number of updates per second of the active profile, 0 is unlimited
+		 */
+		float getFramerate() const							{ return getProfile().mFramerate; }
+
+		/**
+		 * @return if the night profile is active
+		 */
+		bool isNight() const								{ return mNight; }
+
+		/**
+		 * @return the active profile
+		 */
+		const PowerProfile& getProfile() const				{ return mNight ? mNightProfile : mDayProfile; }
+
+		/**
+		 * @return power consumption counters since init or the last reset
+		 */
+		const PowerCounters& getCounters() const			{ return mCounters; }
+
+		/**
+		 * @return seconds of rendering at the full framerate avoided since init or the last reset
+		 */
+		double getTimeSaved() const;
+
+		/**
+		 * @return estimated energy saved in joules since init or the last reset
+		 */
+		double getEnergySaved() const;
+
+		/**
+		 * Resets all counters.
+		 */
+		void resetCounters()								{ mCounters = {}; }
+
+		/**
+		 * Triggered when the profile switches, receives `true` when switching to the night profile.
+		 */
+		Signal<bool> mProfileChanged;
+
+		ComponentInstancePtr<SunsetCalculatorComponent> mCalculator = { this, &SunsetPowerComponent::mCalculator };
+
+	private:
+		/**
+		 * @return if the sun is in the night phase, the current phase within the hysteresis band
+		 */
+		bool getPhase() const;
+
+		/**
+		 * Sleeps until the next frame is due according to the framerate of the active profile
+		 */
+		void throttle();
+
+		using SteadyTimeStamp = std::chrono::steady_clock::time_point;
+
+		PowerProfile mDayProfile;							///< Profile applied during the day
+		PowerProfile mNightProfile;							///< Profile applied during the night
+		ENightPhase mNightPhase = ENightPhase::SunDown;		///< Sun position at which the night starts
+		double mElevation = 0.0;							///< Sun elevation in degrees at which the night starts
+		double mHysteresis = 1.0;							///< Elevation band in degrees
+		double mHoldTime = 60.0;							///< Seconds a new phase has to hold
+		double mFullFramerate = 60.0;						///< Reference framerate
+		double mFullPower = 100.0;							///< Watts at the full framerate
+		double mIdlePower = 20.0;							///< Watts when not rendering
+
+		bool mNight = false;								///< If the night profile is active
+		double mPendingTime = 0.0;							///< Seconds the phase has differed from the active profile
+		SteadyTimeStamp mNextFrame;							///< Time the next frame is due when the framerate is limited
+		PowerCounters mCounters;							///< Power consumption counters
+	};
+}
@@ -0,0 +1,183 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetraster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+namespace nap
+{
+	namespace sunset
+	{
+		static constexpr double pi = 3.14159265358979323846;
+		static constexpr double degToRad = pi / 180.0;
+		static constexpr double radToDeg = 180.0 / pi;
+
+
+		/**
+		 * Crossings of a single cell in minutes of local mean solar time
+		 */
+		struct Crossings
+		{
+			double mSunrise = NAN;
+			double mSunset = NAN;
+			double mDayLength = 0.0;			///< Minutes of daylight
+		};
+
+
+		/**
+		 * Cosine of the official sunrise hour angle
+		 */
+		static double hourAngleCosine(double sinLatitude, double cosLatitude, double declination)
+		{
+			static const double cos_zenith = std::cos(Engine::officialZenith * degToRad);
+			double dec = declination * degToRad;
+			return (cos_zenith - sinLatitude * std::sin(dec)) / (cosLatitude * std::cos(dec));
+		}
+
+
+		/**
+		 * Refines a crossing with the terms interpolated at the first estimate, NaN if the sun doesn't cross anymore
+		 * @param sign -1 for sunrise, 1 for sunset
+		 */
+		static double refineCrossing(const SolarTerms& terms, double sinLatitude, double cosLatitude, double estimate, double sign)
+		{
+			double x = std::min(std::max(estimate / 720.0, 0.0), 2.0);
+			int i = std::min(static_cast<int>(x), 1);
+			double f = x - i;
+			double declination = terms.mDeclination[i] + (terms.mDeclination[i + 1] - terms.mDeclination[i]) * f;
+			double eq_time = terms.mEquationOfTime[i] + (terms.mEquationOfTime[i + 1] - terms.mEquationOfTime[i]) * f;
+
+			double cos_ha = hourAngleCosine(sinLatitude, cosLatitude, declination);
+			if (std::abs(cos_ha) > 1.0)
+				return NAN;
+			return 720.0 + sign * 4.0 * std::acos(cos_ha) * radToDeg - eq_time;
+		}
+
+
+		static Crossings computeCrossings(const SolarTerms& terms, double sinLatitude, double cosLatitude)
+		{
+			// First estimate using the terms at noon
+			Crossings crossings;
+			double cos_ha = hourAngleCosine(sinLatitude, cosLatitude, terms.mDeclination[1]);
+			if (cos_ha > 1.0)
+				return crossings;
+
+			if (cos_ha < -1.0)
+			{
+				crossings.mDayLength = 1440.0;
+				return crossings;
+			}
+
+			double ha = std::acos(cos_ha) * radToDeg;
+			crossings.mSunrise = refineCrossing(terms, sinLatitude, cosLatitude, 720.0 - 4.0 * ha - terms.mEquationOfTime[1], -1.0);
+			crossings.mSunset = refineCrossing(terms, sinLatitude, cosLatitude, 720.0 + 4.0 * ha - terms.mEquationOfTime[1], 1.0);
+
+			// Fall back to the estimate when a refined crossing left the day
+			crossings.mDayLength = std::isnan(crossings.mSunrise) || std::isnan(crossings.mSunset) ?
+				8.0 * ha : crossings.mSunset - crossings.mSunrise;
+			return crossings;
+		}
+
+
+		/**
+		 * @return local mean solar time in minutes converted to hours UTC, 0-24
+		 */
+		static float toHoursUTC(double minutes, double longitude)
+		{
+			if (std::isnan(minutes))
+				return NAN;
+
+			double utc = std::fmod(minutes - 4.0 * longitude, 1440.0);
+			return static_cast<float>((utc < 0.0 ? utc + 1440.0 : utc) / 60.0);
+		}
+
+
+		bool computeRaster(const Day& day, const RasterSettings& settings, Raster& outRaster, utility::ErrorState& error)
+		{
+			if (!error.check(settings.mResolution > 0.0, "invalid raster resolution: %f", settings.mResolution))
+				return false;
+
+			if (!error.check(settings.mMinLatitude >= -90.0 && settings.mMaxLatitude <= 90.0 && settings.mMinLatitude < settings.mMaxLatitude,
+				"invalid raster latitude range: %f to %f", settings.mMinLatitude, settings.mMaxLatitude))
+				return false;
+
+			if (!error.check(settings.mMinLongitude >= -180.0 && settings.mMaxLongitude <= 180.0 && settings.mMinLongitude < settings.mMaxLongitude,
+				"invalid raster longitude range: %f to %f", settings.mMinLongitude, settings.mMaxLongitude))
+				return false;
+
+			outRaster.mResolution = settings.mResolution;
+			outRaster.mMaxLatitude = settings.mMaxLatitude;
+			outRaster.mMinLongitude = settings.mMinLongitude;
+			outRaster.mWidth = std::max(static_cast<int>(std::round((settings.mMaxLongitude - settings.mMinLongitude) / settings.mResolution)), 1);
+			outRaster.mHeight = std::max(static_cast<int>(std::round((settings.mMaxLatitude - settings.mMinLatitude) / settings.mResolution)), 1);
+			outRaster.mData.resize(static_cast<size_t>(outRaster.mWidth) * outRaster.mHeight);
+
+			// Solar terms of every column, shared by all rows, local mean solar time keeps the day centered on noon
+			std::vector<SolarTerms> columns(outRaster.mWidth);
+			auto engine = createEngine(settings.mEngine);
+			engine->setDate(day.mYear, day.mMonth, day.mDay);
+			for (int column = 0; column < outRaster.mWidth; column++)
+			{
+				double longitude = outRaster.getLongitude(column);
+				engine->setPosition(0.0, longitude, longitude / 15.0);
+				engine->calcSolarTerms(columns[column]);
+			}
+
+			auto compute_row = [&outRaster, &columns, &settings](int row)
+			{
+				double latitude = outRaster.getLatitude(row) * degToRad;
+				double sin_lat = std::sin(latitude);
+				double cos_lat = std::cos(latitude);
+				float* values = &outRaster.mData[static_cast<size_t>(row) * outRaster.mWidth];
+				for (int column = 0; column < outRaster.mWidth; column++)
+				{
+					auto crossings = computeCrossings(columns[column], sin_lat, cos_lat);
+					switch (settings.mValue)
+					{
+					case ERasterValue::Sunrise:
+						values[column] = toHoursUTC(crossings.mSunrise, outRaster.getLongitude(column));
+						break;
+					case ERasterValue::Sunset:
+						values[column] = toHoursUTC(crossings.mSunset, outRaster.getLongitude(column));
+						break;
+					case ERasterValue::DayLength:
+					default:
+						values[column] = static_cast<float>(crossings.mDayLength / 60.0);
+						break;
+					}
+				}
+			};
+
+			parallelFor(static_cast<size_t>(outRaster.mHeight), settings.mThreadCount, [&](size_t row)
+			{
+				compute_row(static_cast<int>(row));
+			});
+			return true;
+		}
+
+
+		bool writeRasterPFM(const Raster& raster, const std::string& path, utility::ErrorState& error)
+		{
+			FILE* file = std::fopen(path.c_str(), "wb");
+			if (!error.check(file != nullptr, "unable to open for writing: %s", path.c_str()))
+				return false;
+
+			// Negative scale marks little endian data, rows are stored bottom to top
+			uint16_t probe = 1;
+			bool little_endian = *reinterpret_cast<uint8_t*>(&probe) == 1;
+			std::fprintf(file, "Pf\n%d %d\n%s\n", raster.mWidth, raster.mHeight, little_endian ? "-1.0" : "1.0");
+
+			bool written = true;
+			for (int row = raster.mHeight - 1; row >= 0 && written; row--)
+				written = std::fwrite(&raster.mData[static_cast<size_t>(row) * raster.mWidth], sizeof(float), raster.mWidth, file) == static_cast<size_t>(raster.mWidth);
+
+			written = std::fclose(file) == 0 && written;
+			return error.check(written, "unable to write: %s", path.c_str());
+		}
+	}
+}
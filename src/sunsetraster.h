@@ -0,0 +1,97 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "sunsetevents.h"
+
+#include <utility/dllexport.h>
+#include <utility/errorstate.h>
+#include <string>
+#include <vector>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Value stored in every cell of a daylight raster.
+		 */
+		enum class ERasterValue : int
+		{
+			DayLength	= 0,	///< Hours of daylight, 0 during polar night and 24 during polar day
+			Sunrise		= 1,	///< Official sunrise in hours UTC, 0-24, NaN if the sun doesn't rise or set
+			Sunset		= 2		///< Official sunset in hours UTC, 0-24, NaN if the sun doesn't rise or set
+		};
+
+
+		/**
+		 * Area, resolution and contents of a daylight raster.
+		 */
+		struct RasterSettings
+		{
+			ERasterValue mValue = ERasterValue::DayLength;	///< Value stored in every cell
+			double mResolution = 0.1;					///< Cell size in degrees
+			double mMinLatitude = -90.0;				///< Southern edge in degrees
+			double mMaxLatitude = 90.0;					///< Northern edge in degrees
+			double mMinLongitude = -180.0;				///< Western edge in degrees
+			double mMaxLongitude = 180.0;				///< Eastern edge in degrees
+			EEngine mEngine = EEngine::NOAA;			///< Engine that computes the solar terms
+			int mThreadCount = 0;						///< Number of threads to use, 0 uses all available cores
+		};
+
+
+		/**
+		 * 2D grid of float values over latitude and longitude.
+		 * Row 0 is the northern edge, column 0 the western edge, values are sampled at cell centers.
+		 */
+		struct NAPAPI Raster
+		{
+			int mWidth = 0;								///< Number of columns
+			int mHeight = 0;							///< Number of rows
+			double mResolution = 0.0;					///< Cell size in degrees
+			double mMaxLatitude = 0.0;					///< Northern edge in degrees
+			double mMinLongitude = 0.0;					///< Western edge in degrees
+			std::vector<float> mData;					///< Values row by row, north to south
+
+			/**
+			 * @return value of a cell
+			 */
+			float get(int column, int row) const		{ return mData[static_cast<size_t>(row) * mWidth + column]; }
+
+			/**
+			 * @return latitude of the center of a row in degrees
+			 */
+			double getLatitude(int row) const			{ return mMaxLatitude - (row + 0.5) * mResolution; }
+
+			/**
+			 * @return longitude of the center of a column in degrees
+			 */
+			double getLongitude(int column) const		{ return mMinLongitude + (column + 0.5) * mResolution; }
+		};
+
+
+		/**
+		 * Fills a raster with daylight values on the given day, for example hours of daylight over the globe.
+		 * The solar terms are computed once per column, at local mean midnight, noon and the next midnight of the day,
+		 * every cell only solves the hour angle of its latitude. Like the sunset library the crossing is solved twice,
+		 * the second time with the terms interpolated at the first estimate. Rows are processed in parallel.
+		 * @param day the local calendar day of every column
+		 * @param settings area, resolution and contents of the raster
+		 * @param outRaster receives the raster
+		 * @param error contains the error if the settings are invalid
+		 * @return if the raster is computed
+		 */
+		bool NAPAPI computeRaster(const Day& day, const RasterSettings& settings, Raster& outRaster, utility::ErrorState& error);
+
+		/**
+		 * Writes a raster as a single channel Portable Float Map (PFM), readable by most HDR image tools.
+		 * @param raster the raster to write
+		 * @param path the file to write
+		 * @param error contains the error if the file can't be written
+		 * @return if the file is written
+		 */
+		bool NAPAPI writeRasterPFM(const Raster& raster, const std::string& path, utility::ErrorState& error);
+	}
+}
@@ -0,0 +1,481 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetseasons.h"
+
+#include <sunset.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace nap
+{
+	namespace sunset
+	{
+		static constexpr double invPhi = 0.61803398874989484820;
+		static constexpr double infinity = std::numeric_limits<double>::infinity();
+
+		// Instants are solved to within this many days, about 0.1 second
+		static constexpr double instantTolerance = 1e-6;
+
+		// Days the solstices and equinoxes are searched around: they drift less than 2 days over the Gregorian calendar
+		static constexpr int instantBracket = 5;
+
+		// Interval in days the year is sampled at to bracket the extremes of a site
+		static constexpr int scanStep = 14;
+
+		// Sun elevation of the official sunrise and sunset
+		static constexpr double horizonElevation = 90.0 - Engine::officialZenith;
+
+		// Polar days and nights require a latitude of at least 90 - 23.44 (max declination) - 0.833 (horizon) degrees
+		static constexpr double minPolarLatitude = 65.0;
+
+		// Number of sites processed in one go, a site takes tens of microseconds
+		static constexpr size_t chunkSize = 16;
+
+
+		/**
+		 * Solar declination at any instant, using the NOAA model of the sunset library
+		 */
+		class Declination
+		{
+		public:
+			Declination()									{ mModel.setPosition(0.0, 0.0, 0.0); }
+
+			/**
+			 * @param dayNumber fractional days since 1970-01-01 UTC
+			 * @return solar declination in degrees
+			 */
+			double operator()(double dayNumber)
+			{
+				int day_number = static_cast<int>(std::floor(dayNumber));
+				Day day = fromDayNumber(day_number);
+				mModel.setCurrentDate(day.mYear, day.mMonth, day.mDay);
+
+				double declination, equation_of_time;
+				mModel.calcSolarTerms((dayNumber - day_number) * 1440.0, declination, equation_of_time);
+				mEvaluations++;
+				return declination;
+			}
+
+			int mEvaluations = 0;
+
+		private:
+			SunSet mModel;
+		};
+
+
+		/**
+		 * Brent's method: root of f bracketed by [a, b], f(a) and f(b) of opposite sign
+		 */
+		template<typename F>
+		static double findRoot(F&& f, double a, double b, double tolerance)
+		{
+			double fa = f(a), fb = f(b);
+			double c = a, fc = fa, d = b - a, e = d;
+			while (true)
+			{
+				if ((fb > 0.0) == (fc > 0.0))
+				{
+					c = a; fc = fa;
+					d = e = b - a;
+				}
+				if (std::abs(fc) < std::abs(fb))
+				{
+					a = b; b = c; c = a;
+					fa = fb; fb = fc; fc = fa;
+				}
+
+				double tol = 2.0 * std::numeric_limits<double>::epsilon() * std::abs(b) + 0.5 * tolerance;
+				double m = 0.5 * (c - b);
+				if (std::abs(m) <= tol || fb == 0.0)
+					return b;
+
+				// Interpolate when the previous step converged well enough, bisect otherwise
+				if (std::abs(e) >= tol && std::abs(fa) > std::abs(fb))
+				{
+					double p, q, s = fb / fa;
+					if (a == c)
+					{
+						// Secant
+						p = 2.0 * m * s;
+						q = 1.0 - s;
+					}
+					else
+					{
+						// Inverse quadratic
+						double r = fb / fc;
+						q = fa / fc;
+						p = s * (2.0 * m * q * (q - r) - (b - a) * (r - 1.0));
+						q = (q - 1.0) * (r - 1.0) * (s - 1.0);
+					}
+					if (p > 0.0)
+						q = -q;
+					else
+						p = -p;
+
+					if (2.0 * p < std::min(3.0 * m * q - std::abs(tol * q), std::abs(e * q)))
+					{
+						e = d;
+						d = p / q;
+					}
+					else
+					{
+						d = m;
+						e = m;
+					}
+				}
+				else
+				{
+					d = m;
+					e = m;
+				}
+
+				a = b; fa = fb;
+				b += std::abs(d) > tol ? d : (m > 0.0 ? tol : -tol);
+				fb = f(b);
+			}
+		}
+
+
+		/**
+		 * Golden-section search: minimum of f, unimodal on [a, b]
+		 */
+		template<typename F>
+		static double findMinimum(F&& f, double a, double b, double tolerance)
+		{
+			double c = b - invPhi * (b - a);
+			double d = a + invPhi * (b - a);
+			double fc = f(c), fd = f(d);
+			while (b - a > tolerance)
+			{
+				if (fc < fd)
+				{
+					b = d; d = c; fd = fc;
+					c = b - invPhi * (b - a);
+					fc = f(c);
+				}
+				else
+				{
+					a = c; c = d; fc = fd;
+					d = a + invPhi * (b - a);
+					fd = f(d);
+				}
+			}
+			return 0.5 * (a + b);
+		}
+
+
+		/**
+		 * Golden-section search over integers: first minimum of f, unimodal on [low, high].
+		 * f is expected to cache its values, probes of consecutive steps coincide most of the time.
+		 */
+		template<typename F>
+		static int findMinimumDay(F&& f, int low, int high)
+		{
+			while (high - low > 3)
+			{
+				int length = high - low;
+				int a = high - static_cast<int>(std::lround(length * invPhi));
+				int b = std::max(low + static_cast<int>(std::lround(length * invPhi)), a + 1);
+				if (f(a) <= f(b))
+					high = b;
+				else
+					low = a;
+			}
+
+			int best = low;
+			for (int day = low + 1; day <= high; day++)
+				best = f(day) < f(best) ? day : best;
+			return best;
+		}
+
+
+		void computeSeasonInstants(int year, SeasonInstants& outInstants)
+		{
+			Declination declination;
+			auto bracket = [year](int month, int day, double& outLow, double& outHigh)
+			{
+				double center = toDayNumber({ year, month, day });
+				outLow = center - instantBracket;
+				outHigh = center + instantBracket;
+			};
+
+			double low, high;
+			outInstants.mYear = year;
+			bracket(3, 20, low, high);
+			outInstants.mMarchEquinox = findRoot(declination, low, high, instantTolerance);
+			bracket(6, 21, low, high);
+			outInstants.mJuneSolstice = findMinimum([&declination](double day) { return -declination(day); }, low, high, instantTolerance);
+			bracket(9, 22, low, high);
+			outInstants.mSeptemberEquinox = findRoot(declination, low, high, instantTolerance);
+			bracket(12, 21, low, high);
+			outInstants.mDecemberSolstice = findMinimum(declination, low, high, instantTolerance);
+			outInstants.mEvaluations = declination.mEvaluations;
+		}
+
+
+		/**
+		 * Polar state of a day, from the sun elevation at noon and midnight
+		 */
+		enum class EPolar : int
+		{
+			Night	= -1,	///< Sun stays below the horizon
+			None	= 0,	///< Sun rises and sets
+			Day		= 1		///< Sun stays above the horizon
+		};
+
+
+		/**
+		 * Computes sunrise, sunset, day length and polar state of the days of a year on demand, every day at most once
+		 */
+		class YearSampler
+		{
+		public:
+			YearSampler(Engine& engine, const Location& location, int year) :
+				mEngine(engine),
+				mLatitude(location.mLatitude),
+				mFirstDay(toDayNumber({ year, 1, 1 })),
+				mDayCount(toDayNumber({ year + 1, 1, 1 }) - mFirstDay)
+			{
+				mEngine.setPosition(location.mLatitude, location.mLongitude, location.mTimezone);
+				std::fill(std::begin(mDeclinations), std::end(mDeclinations), NAN);
+			}
+
+			/**
+			 * Sunrise, sunset and day length of a single day
+			 */
+			struct Sample
+			{
+				double mSunrise = 0.0;
+				double mSunset = 0.0;
+				double mLength = 0.0;
+				bool mComputed = false;
+			};
+
+			const Sample& get(int dayOfYear)
+			{
+				auto& sample = mSamples[dayOfYear];
+				if (sample.mComputed)
+					return sample;
+
+				setDate(dayOfYear);
+				sample.mSunrise = mEngine.calcSunrise();
+				sample.mSunset = mEngine.calcSunset();
+				sample.mComputed = true;
+
+				// Declination is only needed to tell polar day from night
+				Events events = { sample.mSunrise, sample.mSunset };
+				bool rises_and_sets = !std::isnan(events.mSunrise) && !std::isnan(events.mSunset);
+				sample.mLength = getDayLength(events, mLatitude, rises_and_sets ? 0.0 : getDeclination(dayOfYear));
+				return sample;
+			}
+
+			EPolar getPolar(int dayOfYear)
+			{
+				double noon, midnight;
+				getElevations(dayOfYear, noon, midnight);
+				return noon <= horizonElevation ? EPolar::Night :
+					midnight >= horizonElevation ? EPolar::Day : EPolar::None;
+			}
+
+			double getLatitude() const						{ return mLatitude; }
+			int getDayCount() const							{ return mDayCount; }
+			int getEvaluations() const						{ return mEvaluations; }
+
+		private:
+			/**
+			 * Solar declination at noon of a day, cached
+			 */
+			double getDeclination(int dayOfYear)
+			{
+				double& declination = mDeclinations[dayOfYear];
+				if (std::isnan(declination))
+				{
+					SolarTerms terms;
+					setDate(dayOfYear);
+					mEngine.calcSolarTerms(terms);
+					declination = terms.mDeclination[1];
+				}
+				return declination;
+			}
+
+			/**
+			 * Sun elevation at noon and midnight from the noon declination
+			 */
+			void getElevations(int dayOfYear, double& outNoon, double& outMidnight)
+			{
+				double declination = getDeclination(dayOfYear);
+				outNoon = 90.0 - std::abs(mLatitude - declination);
+				outMidnight = std::abs(mLatitude + declination) - 90.0;
+			}
+
+			void setDate(int dayOfYear)
+			{
+				if (dayOfYear == mDate)
+					return;
+
+				Day day = fromDayNumber(mFirstDay + dayOfYear);
+				mEngine.setDate(day.mYear, day.mMonth, day.mDay);
+				mDate = dayOfYear;
+				mEvaluations++;
+			}
+
+			Engine& mEngine;
+			double mLatitude = 0.0;
+			int mFirstDay = 0;
+			int mDayCount = 0;
+			int mDate = -1;
+			int mEvaluations = 0;
+			Sample mSamples[366];
+			double mDeclinations[366];
+		};
+
+
+		/**
+		 * Samples the year every 'scanStep' days and at the solstices.
+		 * Between solstices the declination is monotonic and so is the polar state: changes of state are bisected
+		 * to their exact day, extremes at the start or end of a short polar day or night are never missed.
+		 * @param outCandidates receives the sampled days, sorted
+		 */
+		static void scanYear(YearSampler& sampler, int year, std::vector<int>& outCandidates)
+		{
+			int last = sampler.getDayCount() - 1;
+			int first_day = toDayNumber({ year, 1, 1 });
+			int solstices[] = { toDayNumber({ year, 6, 21 }) - first_day, toDayNumber({ year, 12, 21 }) - first_day };
+
+			outCandidates.clear();
+			for (int day = 0; day <= last; day += scanStep)
+				outCandidates.emplace_back(day);
+			outCandidates.insert(outCandidates.end(), { solstices[0], solstices[1], last });
+
+			// No polar day or night closer to the equator
+			if (std::abs(sampler.getLatitude()) < minPolarLatitude)
+			{
+				std::sort(outCandidates.begin(), outCandidates.end());
+				return;
+			}
+
+			int bounds[] = { 0, solstices[0], solstices[1], last };
+			for (int i = 0; i < 3; i++)
+			{
+				int low = bounds[i];
+				int end = bounds[i + 1];
+				while (sampler.getPolar(low) != sampler.getPolar(end))
+				{
+					// Last day of the state of 'low', the day after it is in the next state
+					auto state = sampler.getPolar(low);
+					int high = end;
+					while (high - low > 1)
+					{
+						int middle = (low + high) / 2;
+						if (sampler.getPolar(middle) == state)
+							low = middle;
+						else
+							high = middle;
+					}
+					outCandidates.insert(outCandidates.end(), { low, high });
+					low = high;
+				}
+			}
+
+			std::sort(outCandidates.begin(), outCandidates.end());
+			outCandidates.erase(std::unique(outCandidates.begin(), outCandidates.end()), outCandidates.end());
+
+			// The engine doesn't find sunrise or sunset on the first and last days the sun barely rises or sets,
+			// sample the middle of short runs that start or end with such a day
+			auto undefined = [&sampler](int day)
+			{
+				const auto& sample = sampler.get(day);
+				return std::isnan(sample.mSunrise) || std::isnan(sample.mSunset);
+			};
+
+			size_t count = outCandidates.size();
+			for (size_t i = 1; i < count; i++)
+			{
+				int low = outCandidates[i - 1];
+				int high = outCandidates[i];
+				if (high - low > 1 && sampler.getPolar(low) == EPolar::None && sampler.getPolar(high) == EPolar::None &&
+					(undefined(low) || undefined(high)))
+					outCandidates.emplace_back((low + high) / 2);
+			}
+			std::sort(outCandidates.begin(), outCandidates.end());
+		}
+
+
+		/**
+		 * Refines every candidate day that is a local minimum of f with the days between its neighbouring candidates,
+		 * the value can have multiple minima over the year, for example sunset near the equator.
+		 */
+		template<typename F>
+		static Extremum findExtremum(const std::vector<int>& candidates, F&& f, double sign)
+		{
+			Extremum extremum;
+			double best = infinity;
+			int count = static_cast<int>(candidates.size());
+			for (int i = 0; i < count; i++)
+			{
+				double value = f(candidates[i]);
+				if (std::isinf(value) ||
+					(i > 0 && f(candidates[i - 1]) < value) ||
+					(i + 1 < count && f(candidates[i + 1]) < value))
+					continue;
+
+				// Polar days and nights are flat, any of their days is the extremum
+				int low = candidates[std::max(i - 1, 0)];
+				int high = candidates[std::min(i + 1, count - 1)];
+				int day = f(low) == value && f(high) == value ? candidates[i] : findMinimumDay(f, low, high);
+				if (f(day) < best)
+				{
+					best = f(day);
+					extremum.mDayOfYear = day;
+					extremum.mValue = sign * best;
+				}
+			}
+			return extremum;
+		}
+
+
+		static void computeSiteSeasons(Engine& engine, const Location& location, int year, SiteSeasons& outSeasons)
+		{
+			YearSampler sampler(engine, location, year);
+			std::vector<int> candidates;
+			scanYear(sampler, year, candidates);
+
+			auto defined = [](double value) { return std::isnan(value) ? infinity : value; };
+			outSeasons.mEarliestSunset = findExtremum(candidates, [&](int day) { return defined(sampler.get(day).mSunset); }, 1.0);
+			outSeasons.mLatestSunrise = findExtremum(candidates, [&](int day) { return defined(-sampler.get(day).mSunrise); }, -1.0);
+			outSeasons.mLongestDay = findExtremum(candidates, [&](int day) { return -sampler.get(day).mLength; }, -1.0);
+			outSeasons.mShortestDay = findExtremum(candidates, [&](int day) { return sampler.get(day).mLength; }, 1.0);
+			outSeasons.mEvaluations = sampler.getEvaluations();
+		}
+
+
+		void computeSiteSeasons(const Location& location, int year, SiteSeasons& outSeasons, EEngine engine)
+		{
+			auto model = createEngine(engine);
+			computeSiteSeasons(*model, location, year, outSeasons);
+		}
+
+
+		void computeSiteSeasons(const Location* locations, size_t count, int year, SiteSeasons* outSeasons, int threadCount, EEngine engine)
+		{
+			size_t chunk_count = (count + chunkSize - 1) / chunkSize;
+			parallelFor(chunk_count, threadCount, [&](size_t chunk)
+			{
+				auto model = createEngine(engine);
+				size_t last = std::min((chunk + 1) * chunkSize, count);
+				for (size_t i = chunk * chunkSize; i < last; i++)
+					computeSiteSeasons(*model, locations[i], year, outSeasons[i]);
+			});
+		}
+
+
+		void computeSiteSeasons(const std::vector<Location>& locations, int year, std::vector<SiteSeasons>& outSeasons, int threadCount, EEngine engine)
+		{
+			outSeasons.resize(locations.size());
+			computeSiteSeasons(locations.data(), locations.size(), year, outSeasons.data(), threadCount, engine);
+		}
+	}
+}
@@ -0,0 +1,102 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "sunsetevents.h"
+
+#include <utility/dllexport.h>
+#include <vector>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Solstices and equinoxes of a year, in fractional days since 1970-01-01 UTC.
+		 * Use sunset::fromDayNumber() on the value rounded down to get the calendar day,
+		 * the fraction times 1440 is the time in minutes past midnight UTC.
+		 */
+		struct SeasonInstants
+		{
+			int mYear = 0;								///< 4 digit year
+			double mMarchEquinox = 0.0;					///< Sun crosses the celestial equator going north
+			double mJuneSolstice = 0.0;					///< Northernmost declination of the sun
+			double mSeptemberEquinox = 0.0;				///< Sun crosses the celestial equator going south
+			double mDecemberSolstice = 0.0;				///< Southernmost declination of the sun
+			int mEvaluations = 0;						///< Number of times the solar declination was computed
+		};
+
+		/**
+		 * Day of the year on which a daily value is most extreme.
+		 */
+		struct Extremum
+		{
+			int mDayOfYear = -1;						///< Day of the extremum, 0 = January 1st, -1 when the value is undefined all year
+			double mValue = 0.0;						///< Value on that day
+		};
+
+		/**
+		 * Seasonal extremes of sunrise, sunset and day length of a site over a year.
+		 * Sunrise and sunset are in minutes past local midnight, day length in minutes.
+		 * Days without sunrise or sunset count as 1440 minutes of daylight (polar day) or none (polar night),
+		 * whichever the sun is closest to, and are skipped for the earliest sunset and latest sunrise.
+		 */
+		struct SiteSeasons
+		{
+			Extremum mEarliestSunset;					///< Earliest sunset
+			Extremum mLatestSunrise;					///< Latest sunrise
+			Extremum mLongestDay;						///< Most minutes of daylight, a day of the polar day when the sun doesn't set
+			Extremum mShortestDay;						///< Fewest minutes of daylight, a day of the polar night when the sun doesn't rise
+			int mEvaluations = 0;						///< Number of days the engine computed sunrise and sunset or the declination for
+		};
+
+		/**
+		 * Finds the solstices and equinoxes of a year using the solar declination of the sunset library.
+		 * Equinoxes are bracketed roots of the declination, found with Brent's method.
+		 * Solstices are bracketed extremes of the declination, found with golden-section search.
+		 * Both are solved to within a second of the model in about 20 evaluations per instant.
+		 * The model itself is accurate to about 10 minutes.
+		 * @param year 4 digit year
+		 * @param outInstants receives the instants of the year
+		 */
+		void NAPAPI computeSeasonInstants(int year, SeasonInstants& outInstants);
+
+		/**
+		 * Finds the earliest sunset, latest sunrise, longest and shortest day of a site over a year.
+		 * The year is sampled every two weeks and at the solstices to bracket every extremum, which is then refined
+		 * with golden-section search over the days in the bracket. Near the poles the start and end of the polar day
+		 * and night are bisected as well. Samples are shared between extremes: about 60 days are computed
+		 * at mid latitudes and about 100 near the poles, instead of all of them. The result matches an exhaustive search
+		 * unless two extremes of a value are within a few seconds of each other, near the equator.
+		 * @param location the site, including timezone
+		 * @param year 4 digit year
+		 * @param outSeasons receives the extremes of the site
+		 * @param engine the engine used to compute sunrise and sunset
+		 */
+		void NAPAPI computeSiteSeasons(const Location& location, int year, SiteSeasons& outSeasons, EEngine engine = EEngine::NOAA);
+
+		/**
+		 * Finds the seasonal extremes of many sites over a year, see computeSiteSeasons().
+		 * Sites are processed in parallel, small inputs on the calling thread.
+		 * @param locations sites to compute the extremes for
+		 * @param count number of sites
+		 * @param year 4 digit year
+		 * @param outSeasons receives the extremes of every site, must hold 'count' elements
+		 * @param threadCount number of threads to use, 0 uses all available cores
+		 * @param engine the engine used to compute sunrise and sunset
+		 */
+		void NAPAPI computeSiteSeasons(const Location* locations, size_t count, int year, SiteSeasons* outSeasons, int threadCount = 0, EEngine engine = EEngine::NOAA);
+
+		/**
+		 * Finds the seasonal extremes of all sites over a year, see computeSiteSeasons().
+		 * @param locations sites to compute the extremes for
+		 * @param year 4 digit year
+		 * @param outSeasons receives the extremes of every site, resized to match the number of sites
+		 * @param threadCount number of threads to use, 0 uses all available cores
+		 * @param engine the engine used to compute sunrise and sunset
+		 */
+		void NAPAPI computeSiteSeasons(const std::vector<Location>& locations, int year, std::vector<SiteSeasons>& outSeasons, int threadCount = 0, EEngine engine = EEngine::NOAA);
+	}
+}
@@ -0,0 +1,486 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetservice.h"
+#include "sunsetcalculatorcomponent.h"
+
+#include <nap/core.h>
+#include <nap/logger.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+RTTI_BEGIN_CLASS(nap::SunsetServiceConfiguration)
+	RTTI_PROPERTY("TimerThread", &nap::SunsetServiceConfiguration::mTimerThread, nap::rtti::EPropertyMetaData::Default, "Fire transitions at their exact timestamp from a background thread instead of polling every frame")
+	RTTI_PROPERTY("SharedMemoryName", &nap::SunsetServiceConfiguration::mSharedMemoryName, nap::rtti::EPropertyMetaData::Default, "POSIX shared memory segment to publish calculator state to, starts with '/', disabled when empty")
+	RTTI_PROPERTY("SharedMemoryCapacity", &nap::SunsetServiceConfiguration::mSharedMemoryCapacity, nap::rtti::EPropertyMetaData::Default, "Max number of calculators published to shared memory")
+	RTTI_PROPERTY("RolloverBudget", &nap::SunsetServiceConfiguration::mRolloverBudget, nap::rtti::EPropertyMetaData::Default, "Max microseconds per frame spent on day rollover, 0 computes all calculators immediately")
+	RTTI_PROPERTY("EventLogCapacity", &nap::SunsetServiceConfiguration::mEventLogCapacity, nap::rtti::EPropertyMetaData::Default, "Number of recent events kept in the event log, 0 disables the log")
+	RTTI_PROPERTY("ClockJumpThreshold", &nap::SunsetServiceConfiguration::mClockJumpThreshold, nap::rtti::EPropertyMetaData::Default, "Seconds the system clock may drift from the monotonic clock in a frame before it's logged as a jump")
+RTTI_END_CLASS
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::SunsetService)
+	RTTI_CONSTRUCTOR(nap::ServiceConfiguration*)
+RTTI_END_CLASS
+
+namespace nap
+{
+	rtti::TypeInfo SunsetServiceConfiguration::getServiceType() const
+	{
+		return RTTI_OF(SunsetService);
+	}
+
+
+	SunsetService::SunsetService(ServiceConfiguration* configuration) :
+		Service(configuration)
+	{ }
+
+
+	// Milliseconds since the UNIX epoch, as published to shared memory
+	static int64 toEpochMilliseconds(const SystemTimeStamp& time)
+	{
+		return std::chrono::duration_cast<Milliseconds>(time.time_since_epoch()).count();
+	}
+
+
+	bool SunsetService::init(utility::ErrorState& error)
+	{
+		auto* config = getConfiguration<SunsetServiceConfiguration>();
+		mRolloverBudget = config->mRolloverBudget;
+		mEventLog = std::make_unique<sunset::EventLog>(static_cast<size_t>(std::max(config->mEventLogCapacity, 0)));
+		mClockJumpThreshold = config->mClockJumpThreshold;
+		mLastSystemTime = SystemClock::now();
+		mLastSteadyTime = std::chrono::steady_clock::now();
+		if (!config->mSharedMemoryName.empty() && !openSharedMemory(config->mSharedMemoryName, config->mSharedMemoryCapacity, error))
+			return false;
+
+		if (config->mTimerThread)
+			mTimerThread = std::thread(&SunsetService::timerLoop, this);
+		return true;
+	}
+
+
+	void SunsetService::update(double deltaTime)
+	{
+		detectClockJump();
+		processRollovers();
+		if (hasTimerThread())
+			deliverPosted();
+	}
+
+
+	bool SunsetService::waitForNextEvent(double maxSeconds)
+	{
+		// Never wait longer than a day, the next event is infinitely far away without calculators
+		static constexpr double maxWait = 24.0 * 60.0 * 60.0;
+		double timeout = std::min({ getTimeUntilNextEvent(), maxSeconds, maxWait });
+		auto deadline = std::chrono::steady_clock::now() +
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(std::max(timeout, 0.0)));
+
+		// Calculators poll on update
+		if (!hasTimerThread())
+		{
+			std::this_thread::sleep_until(deadline);
+			return false;
+		}
+
+		// Woken by the timer thread as soon as a transition is posted
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mPostedCondition.wait_until(lock, deadline, [this]() { return !mPosted.empty(); });
+		}
+		return deliverPosted() > 0;
+	}
+
+
+	int SunsetService::deliverPosted()
+	{
+		// Take posted transitions, deliver outside of the lock: listeners might schedule new transitions
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mDelivering.swap(mPosted);
+		}
+
+		// Calculators removed after scheduling are skipped
+		int count = 0;
+		for (const auto& transition : mDelivering)
+		{
+			auto it = mCalculators.find(transition.mCalculator);
+			if (it == mCalculators.end())
+				continue;
+			it->second->evaluate(transition.mTime);
+			count++;
+		}
+		mDelivering.clear();
+		return count;
+	}
+
+
+	void SunsetService::shutdown()
+	{
+		closeSharedMemory();
+		if (!hasTimerThread())
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStop = true;
+		}
+		mCondition.notify_one();
+		mTimerThread.join();
+	}
+
+
+	uint64 SunsetService::registerCalculator(SunsetCalculatorComponentInstance& calculator)
+	{
+		uint64 id = mNextID++;
+		mCalculators.emplace(id, &calculator);
+
+		// Claim a shared memory slot, released slots first
+		if (mSharedHeader != nullptr)
+		{
+			uint32 count = mSharedHeader->mCount.load(std::memory_order_relaxed);
+			if (!mFreeSlots.empty())
+			{
+				mSharedSlots.emplace(id, mFreeSlots.back());
+				mFreeSlots.pop_back();
+			}
+			else if (count < mSharedHeader->mCapacity)
+			{
+				mSharedSlots.emplace(id, count);
+				mSharedHeader->mCount.store(count + 1, std::memory_order_release);
+			}
+			else
+			{
+				nap::Logger::warn("%s: shared memory capacity of %d exceeded, not publishing: %s",
+					mSharedName.c_str(), mSharedHeader->mCapacity, calculator.mID.c_str());
+			}
+		}
+		return id;
+	}
+
+
+	void SunsetService::removeCalculator(uint64 id)
+	{
+		mCalculators.erase(id);
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			cancel(id);
+		}
+
+		// Mark the slot unused for readers and release it
+		auto it = mSharedSlots.find(id);
+		if (it == mSharedSlots.end())
+			return;
+
+		if (mSharedHeader != nullptr)
+		{
+			sunset::SharedRecord record = {};
+			record.mState = -1;
+			sunset::writeRecord(mSharedRecords[it->second], record);
+		}
+		mFreeSlots.emplace_back(it->second);
+		mSharedSlots.erase(it);
+	}
+
+
+	void SunsetService::schedule(uint64 id, const std::vector<SystemTimeStamp>& times)
+	{
+		// Only wake the timer thread when a new transition is due before the one it's waiting for
+		bool earliest = false;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			cancel(id);
+			if (times.empty())
+				return;
+
+			auto& entries = mScheduledEntries[id];
+			for (const auto& time : times)
+			{
+				earliest = earliest || mScheduled.empty() || time < mScheduled.begin()->first;
+				entries.emplace_back(mScheduled.emplace(time, id));
+			}
+		}
+		if (earliest)
+			mCondition.notify_one();
+	}
+
+
+	void SunsetService::cancel(uint64 id)
+	{
+		auto it = mScheduledEntries.find(id);
+		if (it != mScheduledEntries.end())
+		{
+			for (const auto& entry : it->second)
+				mScheduled.erase(entry);
+			mScheduledEntries.erase(it);
+		}
+
+		mPosted.erase(std::remove_if(mPosted.begin(), mPosted.end(),
+			[id](const Transition& transition) { return transition.mCalculator == id; }), mPosted.end());
+	}
+
+
+	void SunsetService::requestRollover(uint64 id, const SystemTimeStamp& next)
+	{
+		mRollovers.push({ next, id });
+	}
+
+
+	void SunsetService::processRollovers()
+	{
+		if (mRollovers.empty())
+			return;
+
+		// Always make progress, stop when the budget is spent
+		auto start = std::chrono::steady_clock::now();
+		auto date_time = getCurrentDateTime();
+		do
+		{
+			uint64 id = mRollovers.top().mCalculator;
+			mRollovers.pop();
+
+			// Calculator might be removed or recomputed after moving
+			auto it = mCalculators.find(id);
+			if (it == mCalculators.end() || !it->second->isProvisional())
+				continue;
+
+			// Transitions passed while estimated are caught up on immediately
+			it->second->computeDay(date_time);
+			it->second->evaluate(date_time.getTimeStamp());
+		}
+		while (!mRollovers.empty() &&
+			std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() < mRolloverBudget);
+	}
+
+
+	void SunsetService::timerLoop()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		while (!mStop)
+		{
+			if (mScheduled.empty())
+			{
+				mCondition.wait(lock);
+				continue;
+			}
+
+			// Sleep until the earliest transition is due, or an earlier one is scheduled
+			SystemTimeStamp next = mScheduled.begin()->first;
+			if (SystemClock::now() < next)
+			{
+				mCondition.wait_until(lock, next);
+				continue;
+			}
+
+			// Post all transitions that are due
+			SystemTimeStamp now = SystemClock::now();
+			while (!mScheduled.empty() && mScheduled.begin()->first <= now)
+			{
+				auto entry = mScheduled.begin();
+				auto& entries = mScheduledEntries[entry->second];
+				entries.erase(std::find(entries.begin(), entries.end(), entry));
+				if (entries.empty())
+					mScheduledEntries.erase(entry->second);
+
+				mPosted.push_back({ entry->first, entry->second });
+				mScheduled.erase(entry);
+			}
+
+			// Wake the main thread when it waits for the next event
+			mPostedCondition.notify_one();
+		}
+	}
+
+
+	SystemTimeStamp SunsetService::getNextEventTimeStamp() const
+	{
+		// Exact events of a new day are still being computed
+		auto now = getCurrentTime();
+		if (!mRollovers.empty())
+			return now;
+
+		SystemTimeStamp next = SystemTimeStamp::max();
+		for (const auto& calculator : mCalculators)
+			next = std::min(next, calculator.second->getNextEventTimeStamp());
+		return std::max(next, now);
+	}
+
+
+	double SunsetService::getTimeUntilNextEvent() const
+	{
+		if (mCalculators.empty())
+			return std::numeric_limits<double>::infinity();
+
+		auto now = getCurrentTime();
+		auto next = getNextEventTimeStamp();
+		return std::max(std::chrono::duration<double>(next - now).count(), 0.0);
+	}
+
+
+	bool SunsetService::dumpEventLog(const std::string& path, utility::ErrorState& error) const
+	{
+		return mEventLog->dump(path, error);
+	}
+
+
+	void SunsetService::logEvent(sunset::ELogEvent event, uint64 id, const SunsetCalculatorComponentInstance& calculator,
+		const SystemTimeStamp& time, double value0, double value1)
+	{
+		sunset::LogRecord record;
+		record.mTime = toEpochMilliseconds(SystemClock::now());
+		record.mEventTime = toEpochMilliseconds(time);
+		record.mCalculator = id;
+		record.mEvent = event;
+		record.mState = static_cast<int8>(calculator.getState());
+		record.mValues[0] = value0;
+		record.mValues[1] = value1;
+		std::strncpy(record.mName, calculator.mID.c_str(), sunset::logNameSize - 1);
+		mEventLog->record(record);
+	}
+
+
+	void SunsetService::detectClockJump()
+	{
+		auto system_time = SystemClock::now();
+		auto steady_time = std::chrono::steady_clock::now();
+		double system_delta = std::chrono::duration<double>(system_time - mLastSystemTime).count();
+		double steady_delta = std::chrono::duration<double>(steady_time - mLastSteadyTime).count();
+		mLastSystemTime = system_time;
+		mLastSteadyTime = steady_time;
+		if (std::abs(system_delta - steady_delta) <= mClockJumpThreshold)
+			return;
+
+		sunset::LogRecord record;
+		record.mTime = record.mEventTime = toEpochMilliseconds(system_time);
+		record.mEvent = sunset::ELogEvent::ClockJump;
+		record.mValues[0] = system_delta - steady_delta;
+		record.mValues[1] = steady_delta;
+		std::strncpy(record.mName, "clock", sunset::logNameSize - 1);
+		mEventLog->record(record);
+		nap::Logger::warn("system clock jumped %.3f seconds", system_delta - steady_delta);
+	}
+
+
+	void SunsetService::publish(uint64 id, const SunsetCalculatorComponentInstance& calculator)
+	{
+		auto it = mSharedSlots.find(id);
+		if (mSharedHeader == nullptr || it == mSharedSlots.end())
+			return;
+
+		sunset::SharedRecord record = {};
+		std::strncpy(record.mName, calculator.mID.c_str(), sunset::sharedNameSize - 1);
+		record.mState = static_cast<int32>(calculator.getState());
+		record.mLatitude = calculator.getLatitude();
+		record.mLongitude = calculator.getLongitude();
+		record.mSunrise = toEpochMilliseconds(calculator.mSunRiseStamp);
+		record.mSunset = toEpochMilliseconds(calculator.mSunSetStamp);
+		record.mStateTime = toEpochMilliseconds(calculator.mStateStamp);
+		record.mNextTransition = toEpochMilliseconds(calculator.getNextTransitionTimeStamp());
+		sunset::writeRecord(mSharedRecords[it->second], record);
+	}
+
+
+#ifndef _WIN32
+	bool SunsetService::openSharedMemory(const std::string& name, int capacity, utility::ErrorState& error)
+	{
+		if (!error.check(name.front() == '/', "shared memory name must start with '/': %s", name.c_str()))
+			return false;
+
+		if (!error.check(capacity > 0, "invalid shared memory capacity: %d", capacity))
+			return false;
+
+		// A running publisher holds an exclusive lock on its segment, the system releases it when the publisher stops
+		int fd = shm_open(name.c_str(), O_RDONLY, 0);
+		if (fd >= 0)
+		{
+			bool published = flock(fd, LOCK_EX | LOCK_NB) != 0;
+			int32 publisher = 0;
+			struct stat info;
+			if (published && fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(sunset::SharedHeader))
+			{
+				void* header = mmap(nullptr, sizeof(sunset::SharedHeader), PROT_READ, MAP_SHARED, fd, 0);
+				if (header != MAP_FAILED)
+				{
+					publisher = static_cast<const sunset::SharedHeader*>(header)->mPublisher;
+					munmap(header, sizeof(sunset::SharedHeader));
+				}
+			}
+			close(fd);
+			if (!error.check(!published, "shared memory segment %s is in use by process %d, choose a different 'SharedMemoryName'", name.c_str(), publisher))
+				return false;
+
+			// Left behind by a publisher that stopped without closing it, readers holding the old mapping keep it until they reopen
+			shm_unlink(name.c_str());
+		}
+
+		// Fails when another publisher created the segment in the meantime
+		fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+		if (!error.check(fd >= 0, "unable to create shared memory segment %s: %s", name.c_str(), std::strerror(errno)))
+			return false;
+
+		if (!error.check(flock(fd, LOCK_EX | LOCK_NB) == 0, "unable to lock shared memory segment %s: %s", name.c_str(), std::strerror(errno)))
+		{
+			close(fd);
+			return false;
+		}
+
+		size_t size = sizeof(sunset::SharedHeader) + static_cast<size_t>(capacity) * sizeof(sunset::SharedRecord);
+		void* data = ftruncate(fd, static_cast<off_t>(size)) == 0 ?
+			mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+		if (!error.check(data != MAP_FAILED, "unable to map shared memory segment: %s", name.c_str()))
+		{
+			shm_unlink(name.c_str());
+			close(fd);
+			return false;
+		}
+
+		// Segment is zero initialized: all records unused, sequences even
+		mSharedName = name;
+		mSharedSize = size;
+		mSharedFile = fd;
+		mSharedHeader = static_cast<sunset::SharedHeader*>(data);
+		mSharedRecords = reinterpret_cast<sunset::SharedRecord*>(mSharedHeader + 1);
+		mSharedHeader->mCapacity = static_cast<uint32>(capacity);
+		mSharedHeader->mRecordSize = sizeof(sunset::SharedRecord);
+		mSharedHeader->mVersion = sunset::sharedVersion;
+		mSharedHeader->mCount.store(0, std::memory_order_relaxed);
+		mSharedHeader->mPublisher = static_cast<int32>(getpid());
+		std::atomic_thread_fence(std::memory_order_release);
+		mSharedHeader->mMagic = sunset::sharedMagic;
+		return true;
+	}
+
+
+	void SunsetService::closeSharedMemory()
+	{
+		if (mSharedHeader == nullptr)
+			return;
+
+		// Remove the segment before releasing the lock, a new publisher never sees it as left behind
+		munmap(mSharedHeader, mSharedSize);
+		shm_unlink(mSharedName.c_str());
+		close(mSharedFile);
+		mSharedFile = -1;
+		mSharedHeader = nullptr;
+		mSharedRecords = nullptr;
+		mSharedSlots.clear();
+		mFreeSlots.clear();
+	}
+#else
+	bool SunsetService::openSharedMemory(const std::string& name, int capacity, utility::ErrorState& error)
+	{
+		nap::Logger::warn("shared memory publication requires POSIX shared memory, not publishing: %s", name.c_str());
+		return true;
+	}
+
+
+	void SunsetService::closeSharedMemory()
+	{ }
+#endif
+}
@@ -0,0 +1,276 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <nap/service.h>
+#include <nap/datetime.h>
+
+#include "sunsetsharedmemory.h"
+#include "sunseteventlog.h"
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace nap
+{
+	class SunsetService;
+	class SunsetCalculatorComponentInstance;
+
+	/**
+	 * Sunset service configuration
+	 */
+	class NAPAPI SunsetServiceConfiguration : public ServiceConfiguration
+	{
+		RTTI_ENABLE(ServiceConfiguration)
+	public:
+		bool mTimerThread = false;					///< Property: 'TimerThread' fire transitions at their exact timestamp instead of polling every frame
+		std::string mSharedMemoryName;				///< Property: 'SharedMemoryName' POSIX shared memory segment to publish calculator state to, starts with '/', disabled when empty
+		int mSharedMemoryCapacity = 256;			///< Property: 'SharedMemoryCapacity' max number of calculators published to shared memory
+		double mRolloverBudget = 0.0;				///< Property: 'RolloverBudget' max microseconds per frame spent on day rollover, 0 computes all calculators immediately
+		int mEventLogCapacity = 4096;				///< Property: 'EventLogCapacity' number of recent events kept in the event log, 0 disables the log
+		double mClockJumpThreshold = 1.0;			///< Property: 'ClockJumpThreshold' seconds the system clock may drift from the monotonic clock in a frame before it's logged as a jump
+
+		/**
+		 * @return sunset service type
+		 */
+		virtual rtti::TypeInfo getServiceType() const override;
+	};
+
+
+	/**
+	 * Schedules sunrise, sunset and elevation transitions of all sunset calculators.
+	 *
+	 * By default calculators poll the clock on update, which delays a transition until the next frame.
+	 * Polling already stamps the state with the exact sunrise or sunset time, see SunsetCalculatorComponentInstance::getStateTimeStamp(),
+	 * only delivery is late. With 'TimerThread' enabled a background thread sleeps until the exact timestamp of the next transition,
+	 * posts it and wakes the main loop when it is blocked in waitForNextEvent(), which delivers the transition within milliseconds.
+	 * Posted transitions are otherwise delivered on update.
+	 *
+	 * With 'SharedMemoryName' set the state, today's events and the next transition of every calculator
+	 * are published to a versioned POSIX shared memory segment. Other processes on the same host
+	 * read it lock-free using the header-only nap::sunset::SharedReader, see sunsetsharedmemory.h.
+	 * Initialization fails when another running process publishes to the same segment. A segment left behind
+	 * by a publisher that stopped without closing it is replaced.
+	 *
+	 * With a 'RolloverBudget' calculators don't compute the events of a new day in the frame the day changes.
+	 * They move the previous day by 24 hours as a provisional estimate and the service computes the exact events
+	 * over the following frames, within the budget and ordered by next transition, so the soonest transitions are exact first.
+	 * At least one calculator is computed per frame. A calculator whose state would change on its estimated events computes them immediately,
+	 * transitions are only fired on exact events.
+	 *
+	 * Every transition, elevation crossing, day recompute and system clock jump is recorded in a lock-free event log
+	 * of the most recent 'EventLogCapacity' events, for post-mortem analysis of missed cues.
+	 * Call dumpEventLog() from a crash handler or diagnostics command to write it to a file.
+	 */
+	class NAPAPI SunsetService : public Service
+	{
+		friend class SunsetCalculatorComponentInstance;
+		RTTI_ENABLE(Service)
+	public:
+		/**
+		 * @param configuration service configuration
+		 */
+		SunsetService(ServiceConfiguration* configuration);
+
+		/**
+		 * Starts the timer thread when enabled.
+		 * @param error contains the error if initialization fails
+		 * @return if initialization succeeded
+		 */
+		virtual bool init(utility::ErrorState& error) override;
+
+		/**
+		 * Delivers transitions posted by the timer thread since last update.
+		 * @param deltaTime time in seconds since last update
+		 */
+		virtual void update(double deltaTime) override;
+
+		/**
+		 * Stops the timer thread and removes the shared memory segment.
+		 */
+		virtual void shutdown() override;
+
+		/**
+		 * @return if transitions are fired by the timer thread instead of polled on update
+		 */
+		bool hasTimerThread() const							{ return mTimerThread.joinable(); }
+
+		/**
+		 * @return if day rollover is spread over multiple frames
+		 */
+		bool hasRolloverBudget() const						{ return mRolloverBudget > 0.0; }
+
+		/**
+		 * @return number of calculators waiting for the exact events of the current day
+		 */
+		int getPendingRolloverCount() const					{ return static_cast<int>(mRollovers.size()); }
+
+		/**
+		 * Returns the time of the next event of all calculators: the soonest sunrise, sunset, elevation crossing or day rollover.
+		 * Until then calculators have nothing to do, which allows a headless app to sleep or lower its framerate.
+		 * Visits every calculator, call once per frame at most.
+		 * @return time of the next event, the current time when an update is due immediately
+		 */
+		SystemTimeStamp getNextEventTimeStamp() const;
+
+		/**
+		 * Returns the time in seconds until the next event of all calculators, see getNextEventTimeStamp().
+		 * Moving an observer using SunsetCalculatorComponentInstance::setPosition() can make an update due sooner.
+		 * @return seconds until the next event, 0 when an update is due, infinite without calculators
+		 */
+		double getTimeUntilNextEvent() const;
+
+		/**
+		 * Blocks the calling thread until the next event of all calculators is due, see getTimeUntilNextEvent(),
+		 * or at most 'maxSeconds'. With the timer thread enabled the wait ends as soon as a transition is posted,
+		 * which is delivered before returning: listeners are notified from the calling thread, within milliseconds of the transition.
+		 * Without the timer thread the calling thread sleeps until the event is due, it is delivered on the next update.
+		 * Call from the main thread only, for example in App::update() of a headless app, instead of sleeping.
+		 * @param maxSeconds max number of seconds to wait, bounds the delay of quitting and system clock changes
+		 * @return if transitions were delivered
+		 */
+		bool waitForNextEvent(double maxSeconds);
+
+		/**
+		 * @return log of the most recent events, available after init
+		 */
+		const sunset::EventLog& getEventLog() const			{ return *mEventLog; }
+
+		/**
+		 * Writes the event log as text, oldest event first.
+		 * @param path the file to write
+		 * @param error contains the error if the file can't be written
+		 * @return if the file is written
+		 */
+		bool dumpEventLog(const std::string& path, utility::ErrorState& error) const;
+
+	private:
+		/**
+		 * Scheduled transition of a calculator
+		 */
+		struct Transition
+		{
+			SystemTimeStamp mTime;							///< Exact time of the transition
+			uint64 mCalculator = 0;							///< Calculator id
+			bool operator>(const Transition& other) const	{ return mTime > other.mTime; }
+		};
+
+		/**
+		 * Registers a calculator, called by the calculator on init.
+		 * @return id of the calculator
+		 */
+		uint64 registerCalculator(SunsetCalculatorComponentInstance& calculator);
+
+		/**
+		 * Removes a calculator, pending transitions are discarded.
+		 */
+		void removeCalculator(uint64 id);
+
+		/**
+		 * Replaces the scheduled transitions of a calculator, transitions that are posted but not delivered are discarded.
+		 * @param id calculator id
+		 * @param times the transitions to schedule, empty to cancel all
+		 */
+		void schedule(uint64 id, const std::vector<SystemTimeStamp>& times);
+
+		/**
+		 * Removes the scheduled and posted transitions of a calculator, requires the lock to be held.
+		 */
+		void cancel(uint64 id);
+
+		/**
+		 * Delivers transitions posted by the timer thread, main thread only.
+		 * @return number of transitions delivered
+		 */
+		int deliverPosted();
+
+		/**
+		 * Requests the exact events of a calculator that rolled over to a new day, main thread only.
+		 * @param id calculator id
+		 * @param next provisional time of the next transition, sooner is computed first
+		 */
+		void requestRollover(uint64 id, const SystemTimeStamp& next);
+
+		/**
+		 * Computes the exact events of calculators that rolled over, within the budget.
+		 */
+		void processRollovers();
+
+		/**
+		 * Sleeps until the next transition is due, posts it and wakes the main thread.
+		 */
+		void timerLoop();
+
+		/**
+		 * Publishes the current state of a calculator to shared memory, if enabled.
+		 */
+		void publish(uint64 id, const SunsetCalculatorComponentInstance& calculator);
+
+		/**
+		 * Records an event of a calculator in the event log.
+		 * @param event kind of event
+		 * @param id calculator id
+		 * @param calculator the calculator, provides its name and state
+		 * @param time time of the event
+		 * @param value0 first event specific value, see sunset::ELogEvent
+		 * @param value1 second event specific value, see sunset::ELogEvent
+		 */
+		void logEvent(sunset::ELogEvent event, uint64 id, const SunsetCalculatorComponentInstance& calculator,
+			const SystemTimeStamp& time, double value0, double value1);
+
+		/**
+		 * Logs a jump when the system clock advanced differently from the monotonic clock since last update.
+		 */
+		void detectClockJump();
+
+		/**
+		 * Creates and maps the shared memory segment, fails when another process publishes to it
+		 */
+		bool openSharedMemory(const std::string& name, int capacity, utility::ErrorState& error);
+
+		/**
+		 * Unmaps and removes the shared memory segment
+		 */
+		void closeSharedMemory();
+
+		using TransitionQueue = std::priority_queue<Transition, std::vector<Transition>, std::greater<Transition>>;
+		using TransitionMap = std::multimap<SystemTimeStamp, uint64>;
+
+		std::unordered_map<uint64, SunsetCalculatorComponentInstance*> mCalculators;	///< All registered calculators, main thread only
+		uint64 mNextID = 1;									///< Next calculator id
+
+		std::thread mTimerThread;							///< Fires transitions at their exact timestamp
+		std::mutex mMutex;									///< Guards scheduled and posted transitions
+		std::condition_variable mCondition;					///< Wakes the timer thread
+		std::condition_variable mPostedCondition;			///< Wakes the main thread in waitForNextEvent()
+		TransitionMap mScheduled;							///< Transitions ordered by time
+		std::unordered_map<uint64, std::vector<TransitionMap::iterator>> mScheduledEntries;	///< Scheduled transitions of every calculator
+		std::vector<Transition> mPosted;					///< Transitions that are due, delivered on update or in waitForNextEvent()
+		std::vector<Transition> mDelivering;				///< Transitions being delivered, main thread only
+		bool mStop = false;									///< Stops the timer thread
+
+		double mRolloverBudget = 0.0;						///< Max microseconds per frame spent on day rollover
+		TransitionQueue mRollovers;							///< Calculators waiting for exact events, ordered by provisional next transition
+
+		std::unique_ptr<sunset::EventLog> mEventLog;		///< Most recent events
+		double mClockJumpThreshold = 1.0;					///< Max drift in seconds between system and monotonic clock per frame
+		SystemTimeStamp mLastSystemTime;					///< System time of last update
+		std::chrono::steady_clock::time_point mLastSteadyTime;	///< Monotonic time of last update
+
+		std::string mSharedName;							///< Name of the shared memory segment
+		sunset::SharedHeader* mSharedHeader = nullptr;		///< Mapped shared memory segment, null when disabled
+		sunset::SharedRecord* mSharedRecords = nullptr;		///< Record slots in the shared memory segment
+		size_t mSharedSize = 0;								///< Size of the mapped segment in bytes
+		int mSharedFile = -1;								///< Descriptor of the segment, holds the publisher lock
+		std::unordered_map<uint64, uint32> mSharedSlots;	///< Shared memory slot of every published calculator
+		std::vector<uint32> mFreeSlots;						///< Slots released by removed calculators
+	};
+}
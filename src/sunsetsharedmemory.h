@@ -0,0 +1,238 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+/**
+ * Layout of the shared memory segment the nap::SunsetService publishes calculator state to,
+ * and a header-only reader for consumer processes. Only depends on the standard library and POSIX,
+ * copy this file into processes that don't link NAP.
+ *
+ * The segment starts with a SharedHeader followed by 'mCapacity' SharedRecord slots.
+ * Every record is guarded by a sequence lock: the writer makes the sequence odd while writing and even when done.
+ * Readers never block the writer, they retry when the sequence changed while reading.
+ * Timestamps are milliseconds since the UNIX epoch (UTC), 0 when unknown.
+ * The publisher holds an exclusive flock() on the segment while it publishes, use isPublished() to tell if it still does.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace nap
+{
+	namespace sunset
+	{
+		constexpr uint32_t sharedMagic = 0x534e5553;		///< 'SUNS'
+		constexpr uint32_t sharedVersion = 1;				///< Incremented when the layout changes
+		constexpr size_t sharedNameSize = 64;				///< Max calculator name length, including terminator
+
+		/**
+		 * Segment header
+		 */
+		struct SharedHeader
+		{
+			uint32_t mMagic;								///< Always 'sharedMagic'
+			uint32_t mVersion;								///< Layout version, 'sharedVersion'
+			uint32_t mCapacity;								///< Number of record slots
+			uint32_t mRecordSize;							///< Size of a single record in bytes
+			std::atomic<uint32_t> mCount;					///< Number of slots in use, slots beyond are unused
+			int32_t mPublisher;								///< Process id of the publisher
+			uint32_t mReserved[2];
+		};
+
+		/**
+		 * Published state of a single calculator.
+		 */
+		struct SharedRecord
+		{
+			std::atomic<uint32_t> mSequence;				///< Odd while the writer updates the record
+			int32_t mState;									///< -1 = unused or unknown, 0 = down, 1 = up
+			char mName[sharedNameSize];						///< Calculator id
+			double mLatitude;								///< Latitude in degrees
+			double mLongitude;								///< Longitude in degrees
+			int64_t mSunrise;								///< Today's sunrise
+			int64_t mSunset;								///< Today's sunset
+			int64_t mStateTime;								///< Time the current state started
+			int64_t mNextTransition;						///< Time of the next sunrise or sunset
+		};
+
+		static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared memory sequence lock requires lock free atomics");
+
+
+		/**
+		 * Copies a record while it might be written, retries until the copy is consistent.
+		 * @param record record in shared memory
+		 * @param outRecord receives the consistent copy
+		 */
+		inline void readRecord(const SharedRecord& record, SharedRecord& outRecord)
+		{
+			const size_t offset = sizeof(record.mSequence);
+			uint32_t begin, end;
+			do
+			{
+				begin = record.mSequence.load(std::memory_order_acquire);
+				std::memcpy(reinterpret_cast<char*>(&outRecord) + offset, reinterpret_cast<const char*>(&record) + offset, sizeof(SharedRecord) - offset);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				end = record.mSequence.load(std::memory_order_relaxed);
+			} while ((begin & 1) != 0 || begin != end);
+			outRecord.mSequence.store(end, std::memory_order_relaxed);
+		}
+
+
+		/**
+		 * Writes a record, readers retry until the write completed. Single writer only.
+		 * @param record record in shared memory
+		 * @param value record to publish, the sequence is ignored
+		 */
+		inline void writeRecord(SharedRecord& record, const SharedRecord& value)
+		{
+			const size_t offset = sizeof(record.mSequence);
+			uint32_t sequence = record.mSequence.load(std::memory_order_relaxed);
+			record.mSequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			std::memcpy(reinterpret_cast<char*>(&record) + offset, reinterpret_cast<const char*>(&value) + offset, sizeof(SharedRecord) - offset);
+			record.mSequence.store(sequence + 2, std::memory_order_release);
+		}
+
+
+#ifndef _WIN32
+		/**
+		 * Maps a segment published by the nap::SunsetService read-only, zero-copy.
+		 *
+		 * ~~~~~{.cpp}
+		 *	nap::sunset::SharedReader reader;
+		 *	if (reader.open("/napsunset"))
+		 *	{
+		 *		nap::sunset::SharedRecord record;
+		 *		for (uint32_t i = 0; i < reader.getCount(); i++)
+		 *			reader.read(i, record);
+		 *	}
+		 * ~~~~~
+		 */
+		class SharedReader
+		{
+		public:
+			SharedReader() = default;
+			~SharedReader()										{ close(); }
+			SharedReader(const SharedReader&) = delete;
+			SharedReader& operator=(const SharedReader&) = delete;
+
+			/**
+			 * Maps the segment, fails when it doesn't exist or the layout version doesn't match.
+			 * @param name POSIX shared memory name, starts with '/'
+			 * @return if the segment is mapped
+			 */
+			bool open(const std::string& name)
+			{
+				close();
+				int fd = shm_open(name.c_str(), O_RDONLY, 0);
+				if (fd < 0)
+					return false;
+
+				struct stat info;
+				if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SharedHeader))
+				{
+					::close(fd);
+					return false;
+				}
+
+				void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+				if (data == MAP_FAILED)
+				{
+					::close(fd);
+					return false;
+				}
+
+				mFile = fd;
+				mData = data;
+				mSize = static_cast<size_t>(info.st_size);
+				const auto* header = getHeader();
+				if (header->mMagic != sharedMagic || header->mVersion != sharedVersion || header->mRecordSize != sizeof(SharedRecord) ||
+					mSize < sizeof(SharedHeader) + header->mCapacity * sizeof(SharedRecord))
+				{
+					close();
+					return false;
+				}
+				return true;
+			}
+
+			/**
+			 * Unmaps the segment.
+			 */
+			void close()
+			{
+				if (mData != nullptr)
+					munmap(mData, mSize);
+				if (mFile >= 0)
+					::close(mFile);
+				mData = nullptr;
+				mSize = 0;
+				mFile = -1;
+			}
+
+			/**
+			 * @return if a segment is mapped
+			 */
+			bool isOpen() const									{ return mData != nullptr; }
+
+			/**
+			 * The segment stays mapped when its publisher stops, reopen it to follow a new publisher.
+			 * @return if the publisher of the mapped segment is still running
+			 */
+			bool isPublished() const
+			{
+				if (mFile < 0)
+					return false;
+
+				// The publisher holds an exclusive lock, the system releases it when the publisher stops
+				if (flock(mFile, LOCK_SH | LOCK_NB) != 0)
+					return true;
+				flock(mFile, LOCK_UN);
+				return false;
+			}
+
+			/**
+			 * @return process id of the publisher
+			 */
+			int32_t getPublisher() const						{ return getHeader()->mPublisher; }
+
+			/**
+			 * @return number of slots in use
+			 */
+			uint32_t getCount() const							{ return getHeader()->mCount.load(std::memory_order_acquire); }
+
+			/**
+			 * @param index slot index, smaller than getCount()
+			 * @return the record in shared memory, use read() for a consistent copy
+			 */
+			const SharedRecord& getRecord(uint32_t index) const	{ return getRecords()[index]; }
+
+			/**
+			 * Copies a record consistently.
+			 * @param index slot index, smaller than getCount()
+			 * @param outRecord receives the record
+			 */
+			void read(uint32_t index, SharedRecord& outRecord) const	{ readRecord(getRecords()[index], outRecord); }
+
+		private:
+			const SharedHeader* getHeader() const				{ return static_cast<const SharedHeader*>(mData); }
+			const SharedRecord* getRecords() const				{ return reinterpret_cast<const SharedRecord*>(getHeader() + 1); }
+
+			void* mData = nullptr;
+			size_t mSize = 0;
+			int mFile = -1;
+		};
+#endif
+	}
+}
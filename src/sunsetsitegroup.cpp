@@ -0,0 +1,143 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetsitegroup.h"
+
+namespace nap
+{
+	void SunsetSiteGroup::add(SunsetCalculatorComponentInstance& calculator)
+	{
+		if (mIndex.find(&calculator) != mIndex.end())
+			return;
+
+		// Reuse free slot
+		uint32 index;
+		if (!mFreeSites.empty())
+		{
+			index = mFreeSites.back();
+			mFreeSites.pop_back();
+		}
+		else
+		{
+			index = static_cast<uint32>(mSites.size());
+			mSites.emplace_back();
+		}
+
+		// Account for the initial state without reporting it as a change
+		auto& site = mSites[index];
+		site.mState = SunsetCalculatorComponentInstance::EState::Unknown;
+		account(site, calculator.getState());
+		site.mCalculator = &calculator;
+		mIndex.emplace(&calculator, index);
+		schedule(index);
+	}
+
+
+	void SunsetSiteGroup::remove(SunsetCalculatorComponentInstance& calculator)
+	{
+		auto it = mIndex.find(&calculator);
+		if (it == mIndex.end())
+			return;
+
+		// Scheduled and pending entries of the slot are skipped from now on
+		auto& site = mSites[it->second];
+		site.mCalculator = nullptr;
+		site.mGeneration++;
+		account(site, SunsetCalculatorComponentInstance::EState::Unknown);
+		mFreeSites.emplace_back(it->second);
+		mIndex.erase(it);
+	}
+
+
+	void SunsetSiteGroup::clear()
+	{
+		mSites.clear();
+		mFreeSites.clear();
+		mIndex.clear();
+		mSchedule = {};
+		mPending.clear();
+		mChanged.clear();
+		mUpCount = 0;
+		mDownCount = 0;
+	}
+
+
+	void SunsetSiteGroup::refresh(SunsetCalculatorComponentInstance& calculator)
+	{
+		auto it = mIndex.find(&calculator);
+		if (it == mIndex.end())
+			return;
+
+		mSites[it->second].mGeneration++;
+		account(mSites[it->second], calculator.getState());
+		schedule(it->second);
+	}
+
+
+	void SunsetSiteGroup::update(const SystemTimeStamp& time)
+	{
+		mChanged.clear();
+
+		// Sites that were due before but whose calculator lagged behind
+		mPendingVisit.swap(mPending);
+		for (const auto& entry : mPendingVisit)
+		{
+			if (entry.mGeneration == mSites[entry.mSite].mGeneration)
+				visit(entry.mSite, time);
+		}
+		mPendingVisit.clear();
+
+		// Sites with a transition due
+		while (!mSchedule.empty() && mSchedule.top().mTime <= time)
+		{
+			Entry entry = mSchedule.top();
+			mSchedule.pop();
+			if (entry.mGeneration == mSites[entry.mSite].mGeneration)
+				visit(entry.mSite, time);
+		}
+	}
+
+
+	float SunsetSiteGroup::getUpFraction() const
+	{
+		int count = getCount();
+		return count > 0 ? static_cast<float>(mUpCount) / static_cast<float>(count) : 0.0f;
+	}
+
+
+	void SunsetSiteGroup::account(Site& site, SunsetCalculatorComponentInstance::EState state)
+	{
+		if (state == site.mState)
+			return;
+
+		using EState = SunsetCalculatorComponentInstance::EState;
+		mUpCount += (state == EState::Up ? 1 : 0) - (site.mState == EState::Up ? 1 : 0);
+		mDownCount += (state == EState::Down ? 1 : 0) - (site.mState == EState::Down ? 1 : 0);
+		site.mState = state;
+		if (site.mCalculator != nullptr)
+			mChanged.emplace_back(site.mCalculator);
+	}
+
+
+	void SunsetSiteGroup::schedule(uint32 index)
+	{
+		const auto& site = mSites[index];
+		mSchedule.push({ site.mCalculator->getNextTransitionTimeStamp(), index, site.mGeneration });
+	}
+
+
+	void SunsetSiteGroup::visit(uint32 index, const SystemTimeStamp& time)
+	{
+		auto& site = mSites[index];
+		account(site, site.mCalculator->getState());
+
+		// The calculator hasn't caught up with the transition yet, check again on next update
+		if (site.mCalculator->getNextTransitionTimeStamp() <= time)
+		{
+			mPending.push_back({ time, index, site.mGeneration });
+			return;
+		}
+		schedule(index);
+	}
+}
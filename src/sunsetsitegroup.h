@@ -0,0 +1,129 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "sunsetcalculatorcomponent.h"
+
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace nap
+{
+	/**
+	 * Tracks the sun state of a large group of sunset calculators incrementally.
+	 *
+	 * Sites are kept in a min-heap ordered by their next transition time, update() only visits
+	 * the sites that transitioned since the last call. Day and night counts are maintained as running totals,
+	 * making group queries O(1) and listing the changed sites O(k).
+	 *
+	 * Call update() after the calculators are updated, for example from App::update().
+	 * Call refresh() after moving a calculator, its next transition might have changed.
+	 */
+	class NAPAPI SunsetSiteGroup
+	{
+	public:
+		/**
+		 * Adds a calculator to the group, ignored when already part of the group.
+		 * @param calculator the calculator to add, must outlive its membership of the group
+		 */
+		void add(SunsetCalculatorComponentInstance& calculator);
+
+		/**
+		 * Removes a calculator from the group.
+		 * @param calculator the calculator to remove
+		 */
+		void remove(SunsetCalculatorComponentInstance& calculator);
+
+		/**
+		 * Removes all calculators from the group.
+		 */
+		void clear();
+
+		/**
+		 * Reschedules a calculator, call after moving it.
+		 * @param calculator the calculator to reschedule
+		 */
+		void refresh(SunsetCalculatorComponentInstance& calculator);
+
+		/**
+		 * Visits all sites that transitioned since the last update, updates the counts and changed sites.
+		 * @param time the current time
+		 */
+		void update(const SystemTimeStamp& time);
+
+		/**
+		 * @return number of sites in the group
+		 */
+		int getCount() const											{ return static_cast<int>(mSites.size() - mFreeSites.size()); }
+
+		/**
+		 * @return number of sites in daylight
+		 */
+		int getUpCount() const											{ return mUpCount; }
+
+		/**
+		 * @return number of sites in the dark
+		 */
+		int getDownCount() const										{ return mDownCount; }
+
+		/**
+		 * @return fraction of sites in daylight, 0 when the group is empty
+		 */
+		float getUpFraction() const;
+
+		/**
+		 * @return sites that changed state during the last update
+		 */
+		const std::vector<SunsetCalculatorComponentInstance*>& getChanged() const	{ return mChanged; }
+
+	private:
+		/**
+		 * Group membership of a calculator
+		 */
+		struct Site
+		{
+			SunsetCalculatorComponentInstance* mCalculator = nullptr;	///< Calculator, null when the slot is free
+			SunsetCalculatorComponentInstance::EState mState = SunsetCalculatorComponentInstance::EState::Unknown;	///< State accounted for in the counts
+			uint32 mGeneration = 0;										///< Invalidates scheduled entries of the slot
+		};
+
+		/**
+		 * Next transition of a site
+		 */
+		struct Entry
+		{
+			SystemTimeStamp mTime;										///< Time of the next transition
+			uint32 mSite = 0;											///< Site index
+			uint32 mGeneration = 0;										///< Site generation when scheduled
+			bool operator>(const Entry& other) const					{ return mTime > other.mTime; }
+		};
+
+		/**
+		 * Accounts for the current state of a site in the counts, records the change
+		 */
+		void account(Site& site, SunsetCalculatorComponentInstance::EState state);
+
+		/**
+		 * Schedules the next transition of a site
+		 */
+		void schedule(uint32 index);
+
+		/**
+		 * Checks a site, schedules its next transition or defers it when the calculator didn't transition yet
+		 */
+		void visit(uint32 index, const SystemTimeStamp& time);
+
+		std::vector<Site> mSites;										///< All sites, including free slots
+		std::vector<uint32> mFreeSites;									///< Free site slots
+		std::unordered_map<SunsetCalculatorComponentInstance*, uint32> mIndex;	///< Calculator to site index
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> mSchedule;	///< Sites by next transition
+		std::vector<Entry> mPending;									///< Sites whose calculator didn't catch up with their transition yet
+		std::vector<Entry> mPendingVisit;								///< Pending sites being visited
+		std::vector<SunsetCalculatorComponentInstance*> mChanged;		///< Sites that changed state during the last update
+		int mUpCount = 0;												///< Number of sites in daylight
+		int mDownCount = 0;												///< Number of sites in the dark
+	};
+}
@@ -0,0 +1,123 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetsky.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nap
+{
+	namespace sunset
+	{
+		static constexpr double pi = 3.14159265358979323846;
+		static constexpr double degToRad = pi / 180.0;
+
+		// Keeps 1 / cos(theta) finite at the horizon
+		static constexpr double minCosZenith = 0.01;
+
+
+		/**
+		 * Perez sky luminance distribution coefficients
+		 */
+		struct Perez
+		{
+			double mA, mB, mC, mD, mE;
+
+			double operator()(double zenith, double gamma) const
+			{
+				double cos_gamma = std::cos(gamma);
+				return (1.0 + mA * std::exp(mB / std::max(std::cos(zenith), minCosZenith))) *
+					(1.0 + mC * std::exp(mD * gamma) + mE * cos_gamma * cos_gamma);
+			}
+		};
+
+
+		/**
+		 * Zenith chromaticity: [T^2 T 1] M [ts^3 ts^2 ts 1]
+		 */
+		static double zenithChromaticity(const double matrix[3][4], double turbidity, double sunZenith)
+		{
+			double t[] = { turbidity * turbidity, turbidity, 1.0 };
+			double s[] = { sunZenith * sunZenith * sunZenith, sunZenith * sunZenith, sunZenith, 1.0 };
+			double result = 0.0;
+			for (int r = 0; r < 3; r++)
+				for (int c = 0; c < 4; c++)
+					result += t[r] * matrix[r][c] * s[c];
+			return result;
+		}
+
+
+		void computeSkyColors(double sunElevation, const SkySettings& settings, int width, int height, std::vector<float>& outPixels)
+		{
+			static constexpr double xMatrix[3][4] =
+			{
+				{  0.00166, -0.00375,  0.00209, 0.0 },
+				{ -0.02903,  0.06377, -0.03202, 0.00394 },
+				{  0.11693, -0.21196,  0.06052, 0.25886 }
+			};
+			static constexpr double yMatrix[3][4] =
+			{
+				{  0.00275, -0.00610,  0.00317, 0.0 },
+				{ -0.04214,  0.08970, -0.04153, 0.00516 },
+				{  0.15346, -0.26756,  0.06670, 0.26688 }
+			};
+
+			width = std::max(width, 2);
+			height = std::max(height, 2);
+			outPixels.resize(static_cast<size_t>(width) * height * 4);
+
+			// The model is evaluated for the sun at or above the horizon, faded to black below it
+			double t = settings.mTurbidity;
+			double sun_zenith = (90.0 - std::min(std::max(sunElevation, 0.0), 90.0)) * degToRad;
+			double depression = std::max(-sunElevation, 0.0) / std::max<double>(settings.mTwilight, 1e-3);
+			double fade = std::max(1.0 - depression, 0.0);
+			fade *= fade;
+
+			Perez perez_Y = { 0.1787 * t - 1.4630, -0.3554 * t + 0.4275, -0.0227 * t + 5.3251, 0.1206 * t - 2.5771, -0.0670 * t + 0.3703 };
+			Perez perez_x = { -0.0193 * t - 0.2592, -0.0665 * t + 0.0008, -0.0004 * t + 0.2125, -0.0641 * t - 0.8989, -0.0033 * t + 0.0452 };
+			Perez perez_y = { -0.0167 * t - 0.2608, -0.0950 * t + 0.0092, -0.0079 * t + 0.2102, -0.0441 * t - 1.6537, -0.0109 * t + 0.0529 };
+
+			// Zenith luminance in kcd/m2 and chromaticity
+			double chi = (4.0 / 9.0 - t / 120.0) * (pi - 2.0 * sun_zenith);
+			double zenith_Y = std::max((4.0453 * t - 4.9710) * std::tan(chi) - 0.2155 * t + 2.4192, 0.0);
+			double zenith_x = zenithChromaticity(xMatrix, t, sun_zenith);
+			double zenith_y = zenithChromaticity(yMatrix, t, sun_zenith);
+
+			// Distribution relative to the zenith, gamma of the zenith is the sun zenith angle
+			double norm_Y = zenith_Y / perez_Y(0.0, sun_zenith);
+			double norm_x = zenith_x / perez_x(0.0, sun_zenith);
+			double norm_y = zenith_y / perez_y(0.0, sun_zenith);
+
+			float* pixel = outPixels.data();
+			for (int row = 0; row < height; row++)
+			{
+				double gamma = static_cast<double>(row) / (height - 1) * pi;
+				for (int column = 0; column < width; column++)
+				{
+					double zenith = static_cast<double>(column) / (width - 1) * 0.5 * pi;
+					double Y = norm_Y * perez_Y(zenith, gamma) * fade;
+					double x = norm_x * perez_x(zenith, gamma);
+					double y = std::max(norm_y * perez_y(zenith, gamma), 1e-4);
+
+					// xyY to XYZ to linear sRGB
+					double X = x / y * Y;
+					double Z = (1.0 - x - y) / y * Y;
+					double rgb[] =
+					{
+						 3.2406 * X - 1.5372 * Y - 0.4986 * Z,
+						-0.9689 * X + 1.8758 * Y + 0.0415 * Z,
+						 0.0557 * X - 0.2040 * Y + 1.0570 * Z
+					};
+
+					// Exponential tone mapping
+					for (int c = 0; c < 3; c++)
+						pixel[c] = static_cast<float>(1.0 - std::exp(-std::max(rgb[c], 0.0) * settings.mExposure));
+					pixel[3] = 1.0f;
+					pixel += 4;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,38 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <utility/dllexport.h>
+#include <vector>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Settings of the analytic sky model.
+		 */
+		struct SkySettings
+		{
+			float mTurbidity = 3.0f;				///< Haziness of the atmosphere, 2 (clear) to 10 (hazy)
+			float mExposure = 0.1f;					///< Scales luminance in kcd/m2 before tone mapping
+			float mTwilight = 12.0f;				///< Sun depression in degrees at which the sky is black
+		};
+
+		/**
+		 * Fills a sky color lookup table using the Preetham daylight model (Perez distribution, CIE xyY).
+		 * Texel (x, y) holds the linear RGBA color of the sky in the direction with zenith angle x / (width - 1) * 90 degrees,
+		 * at an angle of y / (height - 1) * 180 degrees from the sun. Colors are tone mapped to [0, 1], alpha is 1.
+		 * The model is only valid with the sun above the horizon: below it the sky of the sun at the horizon is
+		 * faded to black over the twilight depression.
+		 * @param sunElevation sun elevation in degrees
+		 * @param settings sky model settings
+		 * @param width number of zenith angle samples, at least 2
+		 * @param height number of sun angle samples, at least 2
+		 * @param outPixels receives width * height RGBA float pixels, row by row
+		 */
+		void NAPAPI computeSkyColors(double sunElevation, const SkySettings& settings, int width, int height, std::vector<float>& outPixels);
+	}
+}
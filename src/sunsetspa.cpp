@@ -0,0 +1,389 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetspa.h"
+
+#include <cmath>
+
+namespace nap
+{
+	namespace sunset
+	{
+		namespace spa
+		{
+			// Periodic term of the VSOP87 earth model: A * cos(B + C * t)
+			struct Term
+			{
+				double A;
+				double B;
+				double C;
+			};
+
+			// Earth heliocentric longitude terms (Reda & Andreas, table A4.2)
+			static const Term L0[] =
+			{
+				{ 175347046, 0, 0 }, { 3341656, 4.6692568, 6283.07585 }, { 34894, 4.6261, 12566.1517 },
+				{ 3497, 2.7441, 5753.3849 }, { 3418, 2.8289, 3.5231 }, { 3136, 3.6277, 77713.7715 },
+				{ 2676, 4.4181, 7860.4194 }, { 2343, 6.1352, 3930.2097 }, { 1324, 0.7425, 11506.7698 },
+				{ 1273, 2.0371, 529.691 }, { 1199, 1.1096, 1577.3435 }, { 990, 5.233, 5884.927 },
+				{ 902, 2.045, 26.298 }, { 857, 3.508, 398.149 }, { 780, 1.179, 5223.694 },
+				{ 753, 2.533, 5507.553 }, { 505, 4.583, 18849.228 }, { 492, 4.205, 775.523 },
+				{ 357, 2.92, 0.067 }, { 317, 5.849, 11790.629 }, { 284, 1.899, 796.298 },
+				{ 271, 0.315, 10977.079 }, { 243, 0.345, 5486.778 }, { 206, 4.806, 2544.314 },
+				{ 205, 1.869, 5573.143 }, { 202, 2.458, 6069.777 }, { 156, 0.833, 213.299 },
+				{ 132, 3.411, 2942.463 }, { 126, 1.083, 20.775 }, { 115, 0.645, 0.98 },
+				{ 103, 0.636, 4694.003 }, { 102, 0.976, 15720.839 }, { 102, 4.267, 7.114 },
+				{ 99, 6.21, 2146.17 }, { 98, 0.68, 155.42 }, { 86, 5.98, 161000.69 },
+				{ 85, 1.3, 6275.96 }, { 85, 3.67, 71430.7 }, { 80, 1.81, 17260.15 },
+				{ 79, 3.04, 12036.46 }, { 75, 1.76, 5088.63 }, { 74, 3.5, 3154.69 },
+				{ 74, 4.68, 801.82 }, { 70, 0.83, 9437.76 }, { 62, 3.98, 8827.39 },
+				{ 61, 1.82, 7084.9 }, { 57, 2.78, 6286.6 }, { 56, 4.39, 14143.5 },
+				{ 56, 3.47, 6279.55 }, { 52, 0.19, 12139.55 }, { 52, 1.33, 1748.02 },
+				{ 51, 0.28, 5856.48 }, { 49, 0.49, 1194.45 }, { 41, 5.37, 8429.24 },
+				{ 41, 2.4, 19651.05 }, { 39, 6.17, 10447.39 }, { 37, 6.04, 10213.29 },
+				{ 37, 2.57, 1059.38 }, { 36, 1.71, 2352.87 }, { 36, 1.78, 6812.77 },
+				{ 33, 0.59, 17789.85 }, { 30, 0.44, 83996.85 }, { 30, 2.74, 1349.87 },
+				{ 25, 3.16, 4690.48 }
+			};
+
+			static const Term L1[] =
+			{
+				{ 628331966747.0, 0, 0 }, { 206059, 2.678235, 6283.07585 }, { 4303, 2.6351, 12566.1517 },
+				{ 425, 1.59, 3.523 }, { 119, 5.796, 26.298 }, { 109, 2.966, 1577.344 },
+				{ 93, 2.59, 18849.23 }, { 72, 1.14, 529.69 }, { 68, 1.87, 398.15 },
+				{ 67, 4.41, 5507.55 }, { 59, 2.89, 5223.69 }, { 56, 2.17, 155.42 },
+				{ 45, 0.4, 796.3 }, { 36, 0.47, 775.52 }, { 29, 2.65, 7.11 },
+				{ 21, 5.34, 0.98 }, { 19, 1.85, 5486.78 }, { 19, 4.97, 213.3 },
+				{ 17, 2.99, 6275.96 }, { 16, 0.03, 2544.31 }, { 16, 1.43, 2146.17 },
+				{ 15, 1.21, 10977.08 }, { 12, 2.83, 1748.02 }, { 12, 3.26, 5088.63 },
+				{ 12, 5.27, 1194.45 }, { 12, 2.08, 4694 }, { 11, 0.77, 553.57 },
+				{ 10, 1.3, 6286.6 }, { 10, 4.24, 1349.87 }, { 9, 2.7, 242.73 },
+				{ 9, 5.64, 951.72 }, { 8, 5.3, 2352.87 }, { 6, 2.65, 9437.76 },
+				{ 6, 4.67, 4690.48 }
+			};
+
+			static const Term L2[] =
+			{
+				{ 52919, 0, 0 }, { 8720, 1.0721, 6283.0758 }, { 309, 0.867, 12566.152 },
+				{ 27, 0.05, 3.52 }, { 16, 5.19, 26.3 }, { 16, 3.68, 155.42 },
+				{ 10, 0.76, 18849.23 }, { 9, 2.06, 77713.77 }, { 7, 0.83, 775.52 },
+				{ 5, 4.66, 1577.34 }, { 4, 1.03, 7.11 }, { 4, 3.44, 5573.14 },
+				{ 3, 5.14, 796.3 }, { 3, 6.05, 5507.55 }, { 3, 1.19, 242.73 },
+				{ 3, 6.12, 529.69 }, { 3, 0.31, 398.15 }, { 3, 2.28, 553.57 },
+				{ 2, 4.38, 5223.69 }, { 2, 3.75, 0.98 }
+			};
+
+			static const Term L3[] =
+			{
+				{ 289, 5.844, 6283.076 }, { 35, 0, 0 }, { 17, 5.49, 12566.15 },
+				{ 3, 5.2, 155.42 }, { 1, 4.72, 3.52 }, { 1, 5.3, 18849.23 },
+				{ 1, 5.97, 242.73 }
+			};
+
+			static const Term L4[] =
+			{
+				{ 114, 3.142, 0 }, { 8, 4.13, 6283.08 }, { 1, 3.84, 12566.15 }
+			};
+
+			static const Term L5[] =
+			{
+				{ 1, 3.14, 0 }
+			};
+
+			// Earth heliocentric latitude terms
+			static const Term B0[] =
+			{
+				{ 280, 3.199, 84334.662 }, { 102, 5.422, 5507.553 }, { 80, 3.88, 5223.69 },
+				{ 44, 3.7, 2352.87 }, { 32, 4, 1577.34 }
+			};
+
+			static const Term B1[] =
+			{
+				{ 9, 3.9, 5507.55 }, { 6, 1.73, 5223.69 }
+			};
+
+			// Earth radius vector terms
+			static const Term R0[] =
+			{
+				{ 100013989, 0, 0 }, { 1670700, 3.0984635, 6283.07585 }, { 13956, 3.05525, 12566.1517 },
+				{ 3084, 5.1985, 77713.7715 }, { 1628, 1.1739, 5753.3849 }, { 1576, 2.8469, 7860.4194 },
+				{ 925, 5.453, 11506.77 }, { 542, 4.564, 3930.21 }, { 472, 3.661, 5884.927 },
+				{ 346, 0.964, 5507.553 }, { 329, 5.9, 5223.694 }, { 307, 0.299, 5573.143 },
+				{ 243, 4.273, 11790.629 }, { 212, 5.847, 1577.344 }, { 186, 5.022, 10977.079 },
+				{ 175, 3.012, 18849.228 }, { 110, 5.055, 5486.778 }, { 98, 0.89, 6069.78 },
+				{ 86, 5.69, 15720.84 }, { 86, 1.27, 161000.69 }, { 65, 0.27, 17260.15 },
+				{ 63, 0.92, 529.69 }, { 57, 2.01, 83996.85 }, { 56, 5.24, 71430.7 },
+				{ 49, 3.25, 2544.31 }, { 47, 2.58, 775.52 }, { 45, 5.54, 9437.76 },
+				{ 43, 6.01, 6275.96 }, { 39, 5.36, 4694 }, { 38, 2.39, 8827.39 },
+				{ 37, 0.83, 19651.05 }, { 37, 4.9, 12139.55 }, { 36, 1.67, 12036.46 },
+				{ 35, 1.84, 2942.46 }, { 33, 0.24, 7084.9 }, { 32, 0.18, 5088.63 },
+				{ 32, 1.78, 398.15 }, { 28, 1.21, 6286.6 }, { 28, 1.9, 6279.55 },
+				{ 26, 4.59, 10447.39 }
+			};
+
+			static const Term R1[] =
+			{
+				{ 103019, 1.10749, 6283.07585 }, { 1721, 1.0644, 12566.1517 }, { 702, 3.142, 0 },
+				{ 32, 1.02, 18849.23 }, { 31, 2.84, 5507.55 }, { 25, 1.32, 5223.69 },
+				{ 18, 1.42, 1577.34 }, { 10, 5.91, 10977.08 }, { 9, 1.42, 6275.96 },
+				{ 9, 0.27, 5486.78 }
+			};
+
+			static const Term R2[] =
+			{
+				{ 4359, 5.7846, 6283.0758 }, { 124, 5.579, 12566.152 }, { 12, 3.14, 0 },
+				{ 9, 3.63, 77713.77 }, { 6, 1.87, 5573.14 }, { 3, 5.47, 18849.23 }
+			};
+
+			static const Term R3[] =
+			{
+				{ 145, 4.273, 6283.076 }, { 7, 3.92, 12566.15 }
+			};
+
+			static const Term R4[] =
+			{
+				{ 4, 2.56, 6283.08 }
+			};
+
+			static constexpr double degToRad = 3.14159265358979323846 / 180.0;
+			static constexpr double radToDeg = 180.0 / 3.14159265358979323846;
+
+
+			template<size_t N>
+			static double sumTerms(const Term(&terms)[N], double jme)
+			{
+				double sum = 0.0;
+				for (const auto& term : terms)
+					sum += term.A * std::cos(term.B + term.C * jme);
+				return sum;
+			}
+
+
+			// Limits an angle in degrees to 0-360
+			static double limitDegrees(double degrees)
+			{
+				double limited = std::fmod(degrees, 360.0);
+				return limited < 0.0 ? limited + 360.0 : limited;
+			}
+
+
+			double deltaT(double year)
+			{
+				double t = year - 2000.0;
+				if (year < 2005.0)
+					return 63.86 + t * (0.3345 + t * (-0.060374 + t * (0.0017275 + t * (0.000651814 + t * 0.00002373599))));
+				if (year < 2050.0)
+					return 62.92 + t * (0.32217 + t * 0.005589);
+				double u = (year - 1820.0) / 100.0;
+				return -20.0 + 32.0 * u * u - 0.5628 * (2150.0 - year);
+			}
+
+
+			SunPosition computeSunPosition(double jde)
+			{
+				double jce = (jde - 2451545.0) / 36525.0;
+				double jme = jce / 10.0;
+
+				// Earth heliocentric longitude, latitude and radius vector
+				double l = (sumTerms(L0, jme) + jme * (sumTerms(L1, jme) + jme * (sumTerms(L2, jme) +
+					jme * (sumTerms(L3, jme) + jme * (sumTerms(L4, jme) + jme * sumTerms(L5, jme)))))) / 1.0e8;
+				double b = (sumTerms(B0, jme) + jme * sumTerms(B1, jme)) / 1.0e8;
+				double r = (sumTerms(R0, jme) + jme * (sumTerms(R1, jme) + jme * (sumTerms(R2, jme) +
+					jme * (sumTerms(R3, jme) + jme * sumTerms(R4, jme))))) / 1.0e8;
+
+				// Geocentric longitude and latitude
+				double theta = limitDegrees(l * radToDeg + 180.0);
+				double beta = -b * radToDeg;
+
+				// Nutation, low accuracy series: within 0.5" in longitude and 0.1" in obliquity
+				double omega = (125.04452 - 1934.136261 * jce) * degToRad;
+				double lsun = (280.4665 + 36000.7698 * jce) * degToRad;
+				double lmoon = (218.3165 + 481267.8813 * jce) * degToRad;
+				double dpsi = (-17.20 * std::sin(omega) - 1.32 * std::sin(2.0 * lsun) - 0.23 * std::sin(2.0 * lmoon) + 0.21 * std::sin(2.0 * omega)) / 3600.0;
+				double deps = (9.20 * std::cos(omega) + 0.57 * std::cos(2.0 * lsun) + 0.10 * std::cos(2.0 * lmoon) - 0.09 * std::cos(2.0 * omega)) / 3600.0;
+
+				// True obliquity of the ecliptic
+				double eps0 = 84381.448 - jce * (46.8150 + jce * (0.00059 - jce * 0.001813));
+				double eps = eps0 / 3600.0 + deps;
+
+				// Apparent sun longitude, including aberration
+				double lambda = theta + dpsi - 20.4898 / (3600.0 * r);
+
+				// Apparent right ascension and declination
+				double lambda_rad = lambda * degToRad;
+				double eps_rad = eps * degToRad;
+				double beta_rad = beta * degToRad;
+				double alpha = std::atan2(std::sin(lambda_rad) * std::cos(eps_rad) - std::tan(beta_rad) * std::sin(eps_rad), std::cos(lambda_rad));
+				double delta = std::asin(std::sin(beta_rad) * std::cos(eps_rad) + std::cos(beta_rad) * std::sin(eps_rad) * std::sin(lambda_rad));
+
+				SunPosition position;
+				position.mLongitude = limitDegrees(lambda);
+				position.mRightAscension = limitDegrees(alpha * radToDeg);
+				position.mDeclination = delta * radToDeg;
+				position.mNutationLongitude = dpsi;
+				position.mObliquity = eps;
+				return position;
+			}
+
+
+			double apparentSiderealTime(double jd, const SunPosition& position)
+			{
+				double jc = (jd - 2451545.0) / 36525.0;
+				double nu0 = 280.46061837 + 360.98564736629 * (jd - 2451545.0) + jc * jc * (0.000387933 - jc / 38710000.0);
+				return limitDegrees(nu0 + position.mNutationLongitude * std::cos(position.mObliquity * degToRad));
+			}
+
+
+			double julianDay(int year, int month, int day)
+			{
+				if (month <= 2)
+				{
+					year -= 1;
+					month += 12;
+				}
+				double a = std::floor(year / 100.0);
+				double b = 2.0 - a + std::floor(a / 4.0);
+				return std::floor(365.25 * (year + 4716)) + std::floor(30.6001 * (month + 1)) + day + b - 1524.5;
+			}
+		}
+
+
+		//////////////////////////////////////////////////////////////////////////
+		// SPAEngine
+		//////////////////////////////////////////////////////////////////////////
+
+		// Maximum number of refinement steps per crossing and convergence threshold in days (~10 ms)
+		static constexpr int maxRefinements = 4;
+		static constexpr double convergence = 1.0e-7;
+
+
+		// Normalizes an angle in degrees to -180, 180
+		static double normalizeDegrees(double degrees)
+		{
+			return std::remainder(degrees, 360.0);
+		}
+
+
+		void SPAEngine::setDate(int year, int month, int day)
+		{
+			mJulianDay = spa::julianDay(year, month, day);
+			mDeltaT = spa::deltaT(year + (month - 0.5) / 12.0);
+			updatePositions();
+		}
+
+
+		void SPAEngine::setPosition(double latitude, double longitude, double timezone)
+		{
+			mLatitude = latitude;
+			mLongitude = longitude;
+			mTimezone = timezone;
+		}
+
+
+		void SPAEngine::updatePositions()
+		{
+			// Positions at 0h of the previous, current and next day, delta T is accounted for when interpolating
+			for (int i = 0; i < 3; i++)
+			{
+				auto position = spa::computeSunPosition(mJulianDay + static_cast<double>(i - 1));
+				mRightAscension[i] = position.mRightAscension;
+				mDeclination[i] = position.mDeclination;
+				if (i == 1)
+					mSiderealTime = spa::apparentSiderealTime(mJulianDay, position);
+			}
+		}
+
+
+		double SPAEngine::calcCrossing(double elevation, double sign) const
+		{
+			constexpr double deg = spa::degToRad;
+			double lat = mLatitude * deg;
+
+			// Transit, in fractions of a UT day, constrained to the local calendar day
+			double local_midnight = -mTimezone / 24.0;
+			double m0 = (mRightAscension[1] - mLongitude - mSiderealTime) / 360.0;
+			m0 = local_midnight + (m0 - local_midnight - std::floor(m0 - local_midnight));
+
+			// Local hour angle at the target elevation
+			double dec0 = mDeclination[1] * deg;
+			double cos_h0 = (std::sin(elevation * deg) - std::sin(lat) * std::sin(dec0)) / (std::cos(lat) * std::cos(dec0));
+			if (cos_h0 < -1.0)
+				return sign * INFINITY;
+			if (cos_h0 > 1.0)
+				return NAN;
+
+			// Interpolation factors of right ascension and declination
+			double ra = normalizeDegrees(mRightAscension[1] - mRightAscension[0]);
+			double rb = normalizeDegrees(mRightAscension[2] - mRightAscension[1]);
+			double da = mDeclination[1] - mDeclination[0];
+			double db = mDeclination[2] - mDeclination[1];
+
+			// Approximate crossing, refined using the elevation at that time
+			double m = m0 + sign * std::acos(cos_h0) * spa::radToDeg / 360.0;
+			for (int i = 0; i < maxRefinements; i++)
+			{
+				double n = m + mDeltaT / 86400.0;
+				double alpha = mRightAscension[1] + n * (ra + rb + (rb - ra) * n) / 2.0;
+				double delta = (mDeclination[1] + n * (da + db + (db - da) * n) / 2.0) * deg;
+				double nu = mSiderealTime + 360.985647 * m;
+				double h = normalizeDegrees(nu + mLongitude - alpha) * deg;
+				double alt = std::asin(std::sin(lat) * std::sin(delta) + std::cos(lat) * std::cos(delta) * std::cos(h));
+
+				double correction = (alt * spa::radToDeg - elevation) / (360.0 * std::cos(delta) * std::cos(lat) * std::sin(h));
+				m += correction;
+				if (std::abs(correction) < convergence)
+					break;
+			}
+			return (m - local_midnight) * 1440.0;
+		}
+
+
+		double SPAEngine::calcCustomSunrise(double zenith) const
+		{
+			double time = calcCrossing(90.0 - zenith, -1.0);
+			return std::isinf(time) ? NAN : time;
+		}
+
+
+		double SPAEngine::calcCustomSunset(double zenith) const
+		{
+			double time = calcCrossing(90.0 - zenith, 1.0);
+			return std::isinf(time) ? NAN : time;
+		}
+
+
+		void SPAEngine::calcElevationCrossings(const double* elevations, int count, double* outSunrises, double* outSunsets) const
+		{
+			for (int i = 0; i < count; i++)
+			{
+				outSunrises[i] = calcCrossing(elevations[i], -1.0);
+				outSunsets[i] = calcCrossing(elevations[i], 1.0);
+			}
+		}
+	
+
+		void SPAEngine::calcSolarTerms(SolarTerms& outTerms) const
+		{
+			outTerms.mLatitude = mLatitude;
+			outTerms.mLongitude = mLongitude;
+			outTerms.mTimezone = mTimezone;
+			for (int i = 0; i < SolarTerms::sampleCount; i++)
+			{
+				// Local midnight, noon and next midnight
+				double jde = mJulianDay + (720.0 * i - 60.0 * mTimezone) / 1440.0 + mDeltaT / 86400.0;
+				auto position = spa::computeSunPosition(jde);
+
+				// Equation of time from the mean longitude of the sun (Meeus 28.3)
+				double tau = (jde - 2451545.0) / 365250.0;
+				double mean_longitude = 280.4664567 + tau * (360007.6982779 + tau * (0.03032028 +
+					tau * (1.0 / 49931.0 - tau * (1.0 / 15300.0 + tau / 2000000.0))));
+				double eq_time = mean_longitude - 0.0057183 - position.mRightAscension +
+					position.mNutationLongitude * std::cos(position.mObliquity * spa::degToRad);
+
+				outTerms.mDeclination[i] = position.mDeclination;
+				outTerms.mEquationOfTime[i] = 4.0 * normalizeDegrees(eq_time);
+			}
+		}
+	}
+}
@@ -0,0 +1,99 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "sunsetengine.h"
+
+namespace nap
+{
+	namespace sunset
+	{
+		namespace spa
+		{
+			/**
+			 * Apparent geocentric position of the sun.
+			 */
+			struct SunPosition
+			{
+				double mLongitude = 0.0;			///< Apparent ecliptic longitude in degrees
+				double mRightAscension = 0.0;		///< Apparent right ascension in degrees, 0-360
+				double mDeclination = 0.0;			///< Apparent declination in degrees
+				double mNutationLongitude = 0.0;	///< Nutation in longitude in degrees
+				double mObliquity = 0.0;			///< True obliquity of the ecliptic in degrees
+			};
+
+			/**
+			 * Estimates the difference between terrestrial and universal time (Espenak & Meeus).
+			 * @param year fractional year
+			 * @return delta T in seconds
+			 */
+			double NAPAPI deltaT(double year);
+
+			/**
+			 * Computes the apparent position of the sun using a truncated VSOP87 earth model,
+			 * nutation and aberration, following the NREL Solar Position Algorithm.
+			 * @param jde julian ephemeris day
+			 * @return apparent geocentric position of the sun
+			 */
+			SunPosition NAPAPI computeSunPosition(double jde);
+
+			/**
+			 * @param jd julian day (UT)
+			 * @param position position of the sun at that time, provides nutation and obliquity
+			 * @return apparent sidereal time at Greenwich in degrees, 0-360
+			 */
+			double NAPAPI apparentSiderealTime(double jd, const SunPosition& position);
+
+			/**
+			 * @param year 4 digit year
+			 * @param month month, 1 = January
+			 * @param day day of the month, starts at 1
+			 * @return julian day at 0h UT of the given date
+			 */
+			double NAPAPI julianDay(int year, int month, int day);
+		}
+
+
+		/**
+		 * High precision sunrise / sunset engine, based on the NREL Solar Position Algorithm (SPA).
+		 * The apparent position of the sun is computed at 0h UT of the previous, current and next day,
+		 * rise and set are found by interpolating between them and refining against the target elevation.
+		 * Times are relative to the local calendar day, transit always falls between local midnights.
+		 */
+		class NAPAPI SPAEngine : public Engine
+		{
+		public:
+			void setDate(int year, int month, int day) override;
+			void setPosition(double latitude, double longitude, double timezone) override;
+			double calcCustomSunrise(double zenith) const override;
+			double calcCustomSunset(double zenith) const override;
+			void calcElevationCrossings(const double* elevations, int count, double* outSunrises, double* outSunsets) const override;
+			void calcSolarTerms(SolarTerms& outTerms) const override;
+
+		private:
+			/**
+			 * Computes the crossing of the given elevation in minutes past local midnight.
+			 * @param elevation the sun elevation in degrees
+			 * @param sign -1 for sunrise, 1 for sunset
+			 * @return crossing time, -INFINITY or INFINITY if the sun stays above, NaN if it never reaches the elevation
+			 */
+			double calcCrossing(double elevation, double sign) const;
+
+			/**
+			 * Recomputes the sun positions of the previous, current and next day
+			 */
+			void updatePositions();
+
+			double mLatitude = 0.0;
+			double mLongitude = 0.0;
+			double mTimezone = 0.0;
+			double mJulianDay = 2451544.5;
+			double mDeltaT = 0.0;
+			double mSiderealTime = 0.0;				///< Apparent sidereal time at 0h UT
+			double mRightAscension[3];				///< Right ascension at 0h of the previous, current and next day
+			double mDeclination[3];					///< Declination at 0h of the previous, current and next day
+		};
+	}
+}
@@ -0,0 +1,232 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsettimezones.h"
+
+#include <string>
+
+namespace nap
+{
+	namespace sunset
+	{
+		// Hand simplified standard timezone areas, enclaves and exceptions before the areas that surround them.
+		// Split in pieces to stay below the string literal limit of some compilers.
+		static const char* bundledPacific = R"(
+# Pacific
+zone -10 Cook Islands
+-166 -22.5  -157.2 -22.5  -157.2 -8  -166 -8
+zone 14 Line Islands
+-162 -12  -148 -12  -148 6  -162 6
+zone 13 Phoenix Islands
+-176 -6  -170 -6  -170 -1  -176 -1
+zone 13 Tokelau
+-173.5 -10  -170.5 -10  -170.5 -7.5  -173.5 -7.5
+zone 13 Samoa
+-173.5 -15  -171 -15  -171 -12.5  -173.5 -12.5
+zone 13 Tonga
+-177 -24  -172.5 -24  -172.5 -15  -177 -15
+zone 12.75 Chatham Islands
+-177.5 -45  -175.5 -45  -175.5 -43  -177.5 -43
+zone 12 New Zealand
+165 -48  179 -48  179 -33  172 -33  165 -40
+zone 12 Fiji east
+-180 -22  -178 -22  -178 -15  -180 -15
+zone 12 Wallis and Futuna
+-179 -15  -175.5 -15  -175.5 -12.5  -179 -12.5
+zone 12 Marshall Islands
+165 4  173 4  173 15  165 15
+zone -9.5 Marquesas Islands
+-141 -11  -138 -11  -138 -7.5  -141 -7.5
+zone -10 Hawaii
+-161 18.5  -154.5 18.5  -154.5 23  -161 23
+
+# Australia and New Guinea
+zone 9.5 Central Australia
+129 -38  141 -38  141 -26  138 -26  138 -10  129 -10
+zone 8 Western Australia
+112 -36  129 -36  129 -13  112 -20
+zone 10 Eastern Australia
+138 -45  155 -45  155 -9  141.5 -9  138 -16
+zone 10 Papua New Guinea
+141 -9.2  151 -11  155 -11  155 -1  141 -1
+
+# East and Southeast Asia
+zone 9 Korea
+124 33  131 33  131 38.6  129.7 42.5  124 40
+zone 9 Japan
+129 31  131 30.5  136 33.3  140 34.5  142 36  146 43  146 46  141 46  138 39  133 36.5  129.5 34.5
+zone 9 Okinawa
+122.5 24  131 24  131 30  122.5 30
+zone 9 Timor-Leste
+124 -9.6  127.5 -9.6  127.5 -8  124 -8
+zone 9 Eastern Indonesia
+127 -9  141 -9  141 -2  134 1  127 4
+zone 8 Central Indonesia
+114.5 -11  124 -11  127 -9  127 4  118 5  114.5 -4
+zone 8 Philippines
+116.5 4.5  127 4.5  127 21.5  116.5 21.5
+zone 8 Taiwan
+119 21.5  123 21.5  123 26  119 26
+zone 8 Malaysian Borneo and Brunei
+109.5 1  115.5 4  119.5 4.5  119.5 7.5  116 7.5  109.5 2.5
+zone 8 Malaysian Peninsula and Singapore
+100 6.5  101.2 5.7  102.1 6.3  104.5 2.5  104.3 1.1  103.4 1.1  100.5 3.5
+zone 7 Western Indonesia
+94 -11  114.5 -11  114.5 -4  109.5 1  109.5 2.5  104.3 1.1  100.5 3.5  97 6  94 6
+zone 6.5 Myanmar
+92.2 20.5  94 15.5  97.5 15.5  98.5 10  99.5 10.5  98.5 16  101 20  98.5 24.5  97.5 28.5  95.5 27.5  93.5 24
+)";
+
+		static const char* bundledAsia = R"(
+# South and Central Asia
+zone 5.75 Nepal
+80 28.8  84 26.5  88.2 26.4  88.2 27.9  84 29  81 30.4
+zone 6 Bhutan
+88.7 26.7  92.1 26.7  92.1 28.3  88.7 28
+zone 6 Bangladesh
+89 21.6  92.7 20.7  92.5 24.5  91 25.2  89.8 26.2  88.2 26  88.1 24.5  88.8 23.5
+zone 5.5 Sri Lanka
+79.5 5.8  82 5.8  82 10  79.5 10
+zone 5.5 India
+68 23.5  72.5 21  72.6 19  74 15  76.5 8.3  78 8  80 10  80.5 13  81.5 16  84 18  87 21  89 21.6  88.8 23.5  88.1 24.5  88.2 26  89.8 26.2  91 25.2  92.5 24.5  92.2 20.5  93.5 24  95.5 27.5  97.5 28.5  94 29.5  92 27.5  88.7 26.7  88.2 26.4  84 26.5  80 28.8  81 30.4  79 32.5  80 35.5  77.5 35.8  74.5 37  73.5 34.5  74.5 32.5  75 31  71 28  70 25.5
+zone 5 Pakistan
+61 25  66.5 25  68 23.5  70 25.5  71 28  75 31  74.5 32.5  73.5 34.5  74.5 37  71.5 36.5  71 34.5  69.5 33.5  69 31.5  66.5 29.5  62 29.5
+zone 4.5 Afghanistan
+60.5 29.5  62 29.5  66.5 29.5  69 31.5  69.5 33.5  71 34.5  71.5 36.5  74.5 37  71 38.4  67.5 37.2  65 37.5  62 35.5  61 34
+zone 3.5 Iran
+44 39.5  48 38.5  49 37.5  54 37.3  56 38  61 36.5  61 34  60.5 29.5  62 29.5  61 25  57.5 25.5  56.5 27  54 26.5  50.5 29.5  48.5 30  47.5 31.5  46 33  45.5 35  44 37
+zone 6 Kyrgyzstan
+69.5 40  73 39.3  75.5 40.6  80.2 42  80 43  75 43.2  71 42.6
+zone 5 Central Asia
+53 37.3  56 38  61 36.5  62 35.5  65 37.5  67.5 37.2  71 38.4  74.5 37  74.9 37.2  74.8 38.5  73.5 39.5  73 39.3  69.5 40  71 42.6  75 43.2  80 43  80.5 45  83 47  85.5 47  87.3 49  80 50.8  76 54.3  70 55.3  65 54.6  61 53.9  61 50.8  53 51.5  49 48.5  47 47.5  49.2 46.5  50.5 44.5
+zone 7 Western Mongolia
+87.3 49  90 47  95 44.5  95.5 46  93 50  92 50.8  88 50
+zone 8 China and Mongolia
+73.5 39.5  75.5 40.6  80.2 42  80 43  80.5 45  83 47  85.5 47  87.3 49  88 50  92 50.8  98 52  104 50.5  108 49.5  116 50  120 53.5  125.5 53  127.5 49.8  130.5 48.9  132.5 47.7  134.7 48.3  133 45  131 42.5  130.5 42.5  124 40  121.5 38  120 35  122 30  122 25  119 21.5  111.5 18  108.5 18  108 19  108 22.5  101.5 22.5  98.5 24.5  97.5 28.5  94 29.5  92 27.5  88.7 28  84 29  81 30.4  79 32.5  80 35.5  77.5 35.8  74.9 37.2  74.8 38.5
+
+# Caucasus and Middle East
+zone 4 Caucasus
+40 43.5  41.5 41.5  43.5 41.1  43.6 40.1  44.8 39.7  46.5 38.8  48 38.4  49 38.5  50.5 40.5  48.6 41.8  46.6 41.8  44.5 42.7
+zone 3 Turkey
+26 40  26.5 41.7  28 42  33 42  38 41  41.5 41.5  43.5 41.1  43.6 40.1  44.8 39.7  44 37  42 37  39 36.7  36.5 36.2  36 35.8  32 36  27.5 36.5  26 39.5
+zone 2 Israel, Palestine and Lebanon
+34.2 31.2  34.9 29.5  35.5 31.5  35.6 33  36.6 34.5  35.9 34.7  35.2 33.8  35.1 33.1
+zone 4 United Arab Emirates and Oman
+51.5 24.2  52 22.6  55.2 22.7  55 20  52 19  52.8 16.6  55.5 17  59.8 22.5  56.5 26.5  54 24.5
+zone 3 Arabia and the Levant
+34.9 29.5  35.5 27.8  39 21  42.5 16.5  43.2 12.7  45.5 13  52 16.5  55.5 17  59.8 22.5  56.5 27  54 26.5  50.5 29.5  48.5 30  47.5 31.5  46 33  45.5 35  44 37  42 37  39 36.7  36.5 36.2  36 35.8  35.9 34.7  36.6 34.5  35.6 33  35.5 31.5
+)";
+
+		static const char* bundledEurope = R"(
+# Russia
+zone 12 Kamchatka and Chukotka
+155.5 50.5  165 54  180 62  180 72  170 72  160 70.5  162 66  157 62  155.5 56
+zone 12 Chukotka east
+-180 62  -168 64  -168 72  -180 72
+zone 11 Magadan and Sakhalin
+141.5 46  146 43.3  156.5 50.5  155.5 56  157 62  162 66  160 70.5  140 74  140 62  146 60  142 54  141.5 50
+zone 10 Vladivostok
+130.5 42.3  135 43.5  141.5 46  141.5 50  142 54  146 60  140 62  140 72.5  134 72.5  134 64  135 56  131 50  130.5 48
+zone 9 Yakutsk
+112 50  120 49  131 48  131 50  135 56  134 64  134 72.5  125 74  113 74  108 64  106 60  112 56
+zone 8 Irkutsk
+96 50  112 50  112 56  106 60  108 64  100 62  96 58
+zone 6 Omsk
+70.5 53.3  76 53.3  76 58.7  70.5 58.7
+zone 5 Yekaterinburg
+50.8 51  55 50.5  61 50.5  61 53.9  70 53.5  76 58.7  76 60  86 60  86 73  80 82  66 82  64 69  59.5 65  59 61.5  56 61  52 59  53.8 57  53.2 55.5  52.8 51.5
+zone 7 Krasnoyarsk
+76 49  96 49  96 58  100 62  108 64  113 74  110 82  76 82
+zone 4 Udmurtia
+51.2 56  54.3 56  54.3 58.5  51.2 58.5
+zone 4 Samara, Saratov and Astrakhan
+42.5 51.5  44 49.8  46.5 48.5  45 46.5  46.8 45.5  48.5 45.9  49 48  47 49.5  50.8 51  52.8 51.5  53.2 55.5  51 55  49 54.9  46 54.9  46 53  43 52.8
+zone 3 Moscow
+23.2 51.6  30.5 51.3  31.8 52.1  34 52.3  35.5 50.5  40 49.6  39.7 47.8  38.2 47  38 45.5  37 44.7  39.9 43.4  46.7 41.8  48.5 41.8  47.5 43  46.8 45.5  50.8 51  52.8 51.5  53.2 55.5  53.8 57  52 59  56 61  59 61.5  59.5 65  64 69  66 82  30 82  31 70  28.7 69  30 67  29.7 64  31 62.5  29.5 61.5  30 60.5  28 59.4  27.7 57.5  28 56  26.8 55.3  25.8 54.2  24 53.9  23.5 53.9
+
+# Europe
+zone 0 Iceland
+-25 63  -13 63  -13 67  -25 67
+zone -1 Azores
+-32 36.5  -24.5 36.5  -24.5 40  -32 40
+zone 0 Madeira
+-17.5 32.3  -16 32.3  -16 33.2  -17.5 33.2
+zone 0 Canary Islands
+-18.5 27.5  -13 27.5  -13 29.5  -18.5 29.5
+zone 0 United Kingdom and Ireland
+-11 51  -6 49.8  1.5 50.8  1.8 52.8  -0.5 61  -8 58.5  -11 55.5
+zone 0 Portugal
+-9.8 37  -7.4 37.1  -7.5 38.5  -7 39  -7.5 39.7  -6.9 41.9  -8.9 42.1  -9.6 39
+zone 2 Eastern Europe, Libya and Egypt
+20.5 69.1  26 69.9  28.5 70  29 69  36 70  40 48  38 45  36 36  34.9 29.5  36.9 22  25 22  25 20  24 19.5  15 23  12 23.5  10 25  10 30  11.5 33.1  19 37  19.5 39.5  20.6 40.1  21 40.9  22.7 41.3  22.5 42.4  22.4 43.5  22.5 44.2  21.5 44.8  20.3 45.9  21.2 46.2  22.9 48  22.6 48.2  22.2 49.2  23.6 51.5  23.5 53.9  22.8 54.4  19.5 54.4  20 57  19 60  21 63  24 65.8  23.5 68
+zone 1 Central Europe and North Africa
+-10 35.5  -13 27.7  -17.2 21.3  -13 21.3  -13 23  -12 26  -8.7 27.3  -4.8 25  1 21  4 19.2  6 19.5  12 23.5  10 25  10 30  11.5 33.1  19 37  19.5 39.5  20.6 40.1  21 40.9  22.7 41.3  22.5 42.4  22.4 43.5  22.5 44.2  21.5 44.8  20.3 45.9  21.2 46.2  22.9 48  22.6 48.2  22.2 49.2  23.6 51.5  23.5 53.9  22.8 54.4  19.5 54.4  20 57  19 60  21 63  24 65.8  23.5 68  20.5 69.1  26 69.9  28.5 70  29 69  31 70  30 72  5 72  3 62  3 51.5  1.5 50.8  -5 48.5  -2 43.5  -10 44
+)";
+
+		static const char* bundledAfricaAmericas = R"(
+# Africa
+zone -1 Cape Verde
+-25.5 14.5  -22.5 14.5  -22.5 17.5  -25.5 17.5
+zone 0 West Africa
+-18 21.3  -8.7 27.3  -4.8 25  1 21  4 19.2  4.2 16  1 13  1.7 11  1.7 5  -8 4  -14 8  -18 12
+zone 1 West and Central Africa
+1.7 5  1.7 11  1 13  4.2 16  4 19.2  6 19.5  12 23.5  15 23  24 19.5  24 8.5  27.4 5  22 4  20 -1  19.5 -7  18 -8  21.5 -7  22 -11  24 -11  24 -13  22 -13  22 -18  21 -18  11.8 -17.3  8 -10  5 0
+zone 3 East Africa
+29.6 -1.4  29.6 4.2  33.9 4.2  34 5  35 5  34 7  33 8  34.5 9  35 10.7  36.5 14.3  38.5 18  43 13  51.5 12  51.5 10  42 -2  40 -4  40.5 -10.5  34.5 -11.5  32.9 -9.4  30.5 -8.2  30.8 -3.5  30.5 -2.4  30.5 -1.1
+zone 3 Madagascar
+43 -26  51 -26  51 -11.5  48 -11.5  43 -17
+zone 2 Southern and Central Africa
+11.8 -17.3  15 -30  18 -35  33 -35  36 -26  41 -15  41 -10  44 5  44 16  38.5 18  37 22  25 22  24 19.5  24 8.5  27.4 5  22 4  20 -1  19.5 -7  18 -8  21.5 -7  22 -11  24 -11  24 -13  22 -13  22 -18  21 -18
+
+# North America
+zone -2 Greenland
+-60 59  -42 59  -20 70  -18 84  -70 84  -73 78
+zone -3.5 Newfoundland
+-59.5 46.5  -52.5 46.5  -52.5 51.7  -59.5 51.7
+zone -5 Eastern
+-85 29.5  -85 31  -85.6 35  -84.5 36.6  -86 37.5  -87 38.5  -87.5 41.7  -87 45  -90 46.5  -90 48  -90 56.9  -85 65  -85 83  -61 82  -61 67  -64 61  -63 52  -64 49.3  -64.1 48.5  -66.5 48  -67.8 47.3  -67 45  -70 41  -75 35  -80 25  -81 24.5  -82.5 24.5  -84 29.7
+zone -5 Quintana Roo
+-89.2 17.8  -86.7 18  -86.7 21.6  -87.5 21.6  -88.1 21  -87.5 20  -89.2 19.6
+zone -6 Central
+-104.9 30.6  -106.5 31.3  -109 31.3  -108.2 26.3  -106.9 25  -105.8 23  -105 21  -105.5 20  -98 14  -92 12  -84 8  -82.5 8  -82.5 10  -83.5 15  -86 16.5  -87.5 16  -88 18  -87 21.7  -90 22  -97 25.9  -90 29  -84 29.5  -84 46  -88 49  -88 57  -84 66  -84 83  -98 83  -102 68  -102 60  -110 60  -110 49  -104 49  -101 46  -101.5 40  -102 37  -103 36.5  -103 32
+zone -7 Mountain
+-114.7 32.7  -114.8 31.8  -113 31  -113 29  -115 28  -117 27.5  -110 22.5  -105.5 20  -100 25  -100 50  -100 70  -125 78  -141 78  -141 60.3  -124 60  -120 60  -120 53.8  -114 49  -114.5 48  -115.5 46  -116.5 45.5  -117 44  -114 42  -114 36  -114.6 35.1
+zone -9 Alaska
+-141 60.3  -141 72  -169 72  -169 63  -166 60  -169 52.5  -140 54
+zone -10 Aleutian Islands
+-180 50  -169 50  -169 56  -180 56
+zone -4 Dominican Republic
+-71.7 17.5  -68.3 17.5  -68.3 20  -71.7 20
+
+# South America
+zone -4 Venezuela
+-73.4 11  -72 7  -67.5 6  -67 1  -64 1  -60.5 5  -59.8 8.5  -61 10.8  -71.5 12.5
+zone -3 Suriname and French Guiana
+-58 1.8  -51.5 1.8  -51.5 6  -57 6.3
+zone -3 Para and Amapa
+-58.9 -1  -56 -9.3  -50.5 -9.8  -50.5 -5  -52.5 -1  -51.8 4.3  -54 2.2  -56 2  -58.9 1.5
+zone -4 Western Amazonas
+-73.8 -7.1  -70 -4.2  -69.4 -1  -69.5 1.5  -67 2  -66.8 -9.8
+zone -4 Bolivia
+-69.6 -17.3  -68.7 -12.5  -69.5 -11  -65.3 -9.7  -61.5 -13.5  -60.3 -15.1  -58.3 -16.3  -57.5 -18.2  -58.2 -20.2  -62.3 -22.1  -64.3 -22.8  -67.2 -22.8  -68.5 -21  -69.5 -19
+zone -4 Chile
+-70.4 -17.5  -69.5 -19  -68.5 -21  -67.2 -22.8  -68.3 -27  -70 -33  -71.5 -40  -71.7 -45  -72.5 -50  -68.6 -52.3  -68.6 -55  -74 -56  -76 -45  -73 -30  -71 -18
+zone -3 Falkland Islands
+-61.5 -52.5  -57.5 -52.5  -57.5 -51  -61.5 -51
+zone -3 Argentina, Paraguay and Uruguay
+-67.2 -22.8  -64.3 -22.8  -62.3 -22.1  -62.6 -19.3  -58 -19.8  -58 -22  -54.6 -25.6  -53.6 -26.2  -53.8 -27.2  -55.7 -28  -57.6 -30.2  -53.4 -33.7  -53 -34.5  -57 -37  -62 -39  -65 -42  -67 -46  -68.6 -52.3  -65 -55  -68.6 -55.5  -73.5 -50  -72 -40  -70 -30  -68.5 -21
+zone -3 Northeastern Brazil
+-41 -18  -34 -18  -34 -2  -41 -2
+zone -3 Southern Brazil
+-53 -22.5  -54.6 -24  -54.6 -25.6  -53.6 -26.2  -53.8 -27.2  -55.7 -28  -57.6 -30.2  -53.4 -33.7  -50 -30  -50 -22
+)";
+
+
+		const char* getBundledTimeZones()
+		{
+			static const std::string zones = std::string(bundledPacific) + bundledAsia + bundledEurope + bundledAfricaAmericas;
+			return zones.c_str();
+		}
+	}
+}
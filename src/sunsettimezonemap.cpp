@@ -0,0 +1,35 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsettimezonemap.h"
+
+#include <utility/fileutils.h>
+
+RTTI_BEGIN_CLASS(nap::TimeZoneMap)
+	RTTI_PROPERTY_FILELINK("Path", &nap::TimeZoneMap::mPath, nap::rtti::EPropertyMetaData::Default, nap::rtti::EPropertyFileType::Any, "Optional file to read the timezone areas from, the bundled areas are used when empty")
+	RTTI_PROPERTY("CellSize", &nap::TimeZoneMap::mCellSize, nap::rtti::EPropertyMetaData::Default, "Size of a lookup grid cell in degrees")
+RTTI_END_CLASS
+
+namespace nap
+{
+	bool TimeZoneMap::init(utility::ErrorState& errorState)
+	{
+		std::string buffer;
+		if (!mPath.empty())
+		{
+			if (!utility::readFileToString(mPath, buffer, errorState))
+				return false;
+		}
+		else
+		{
+			buffer = sunset::getBundledTimeZones();
+		}
+
+		std::vector<sunset::TimeZoneArea> areas;
+		if (!errorState.check(sunset::parseTimeZones(buffer, areas, errorState), "%s: invalid timezone areas", mID.c_str()))
+			return false;
+
+		return errorState.check(mIndex.build(std::move(areas), mCellSize, errorState), "%s: unable to build timezone index", mID.c_str());
+	}
+}
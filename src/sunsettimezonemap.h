@@ -0,0 +1,50 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <nap/resource.h>
+
+#include "sunsettimezones.h"
+
+namespace nap
+{
+	/**
+	 * Looks up the standard timezone of a location from its latitude and longitude.
+	 * Assign it to a nap::SunsetCalculatorComponent to infer the timezone instead of setting it by hand.
+	 *
+	 * Areas are read from 'Path' when set, see sunset::parseTimeZones() for the format.
+	 * Otherwise the bundled, heavily simplified areas are used: good enough for cities and sites well within a country,
+	 * load a finer dataset for sites near a timezone border. Locations outside all areas get the nautical timezone.
+	 */
+	class NAPAPI TimeZoneMap : public Resource
+	{
+		RTTI_ENABLE(Resource)
+	public:
+		std::string mPath;							///< Property: 'Path' optional file to read the timezone areas from, the bundled areas are used when empty
+		float mCellSize = 1.0f;						///< Property: 'CellSize' size of a lookup grid cell in degrees
+
+		/**
+		 * Reads the areas and builds the lookup index.
+		 * @param errorState contains the error if the areas are invalid
+		 * @return if the map is valid
+		 */
+		virtual bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * @param latitude latitude in degrees
+		 * @param longitude longitude in degrees
+		 * @return standard timezone offset in hours of the location, excluding daylight saving
+		 */
+		double getTimezone(double latitude, double longitude) const			{ return mIndex.getTimezone(latitude, longitude); }
+
+		/**
+		 * @return the lookup index, use it to resolve many locations at once
+		 */
+		const sunset::TimeZoneIndex& getIndex() const						{ return mIndex; }
+
+	private:
+		sunset::TimeZoneIndex mIndex;
+	};
+}
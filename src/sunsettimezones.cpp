@@ -0,0 +1,288 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsettimezones.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Wraps a longitude to [-180, 180)
+		 */
+		static double wrapLongitude(double longitude)
+		{
+			return longitude - 360.0 * std::floor((longitude + 180.0) / 360.0);
+		}
+
+
+		/**
+		 * Liang-Barsky: if the segment intersects the rectangle, including its border
+		 */
+		static bool segmentIntersects(double x0, double y0, double x1, double y1, double minX, double minY, double maxX, double maxY)
+		{
+			double dx = x1 - x0;
+			double dy = y1 - y0;
+			double p[] = { -dx, dx, -dy, dy };
+			double q[] = { x0 - minX, maxX - x0, y0 - minY, maxY - y0 };
+			double t0 = 0.0, t1 = 1.0;
+			for (int i = 0; i < 4; i++)
+			{
+				if (p[i] == 0.0)
+				{
+					if (q[i] < 0.0)
+						return false;
+					continue;
+				}
+				double t = q[i] / p[i];
+				if (p[i] < 0.0)
+					t0 = std::max(t0, t);
+				else
+					t1 = std::min(t1, t);
+				if (t0 > t1)
+					return false;
+			}
+			return true;
+		}
+
+
+		bool TimeZoneArea::contains(double latitude, double longitude) const
+		{
+			// Even-odd rule, horizontal ray towards +longitude
+			bool inside = false;
+			size_t count = mVertices.size() / 2;
+			for (size_t i = 0, j = count - 1; i < count; j = i++)
+			{
+				double xi = mVertices[i * 2], yi = mVertices[i * 2 + 1];
+				double xj = mVertices[j * 2], yj = mVertices[j * 2 + 1];
+				if ((yi > latitude) != (yj > latitude) && longitude < xi + (latitude - yi) * (xj - xi) / (yj - yi))
+					inside = !inside;
+			}
+			return inside;
+		}
+
+
+		bool parseTimeZones(const std::string& text, std::vector<TimeZoneArea>& outAreas, utility::ErrorState& error)
+		{
+			outAreas.clear();
+			std::istringstream lines(text);
+			std::string line;
+			int line_number = 0;
+			while (std::getline(lines, line))
+			{
+				line_number++;
+				line = line.substr(0, line.find('#'));
+				std::istringstream stream(line);
+				std::string token;
+				if (!(stream >> token))
+					continue;
+
+				// New area: offset and name
+				if (token == "zone")
+				{
+					TimeZoneArea area;
+					if (!error.check(static_cast<bool>(stream >> area.mOffset), "line %d: missing timezone offset", line_number))
+						return false;
+					if (!error.check(area.mOffset >= -12.0 && area.mOffset <= 14.0, "line %d: timezone offset out of range: %f", line_number, area.mOffset))
+						return false;
+					std::getline(stream >> std::ws, area.mName);
+					outAreas.emplace_back(std::move(area));
+					continue;
+				}
+
+				// Vertices of the current area
+				if (!error.check(!outAreas.empty(), "line %d: vertices before the first zone", line_number))
+					return false;
+				stream.clear();
+				stream.seekg(0);
+				double value;
+				while (stream >> value)
+					outAreas.back().mVertices.emplace_back(value);
+				if (!error.check(stream.eof(), "line %d: invalid vertex", line_number))
+					return false;
+			}
+
+			for (const auto& area : outAreas)
+			{
+				if (!error.check(area.mVertices.size() % 2 == 0 && area.mVertices.size() >= 6, "%s: polygon needs at least 3 longitude, latitude pairs", area.mName.c_str()))
+					return false;
+
+				for (size_t i = 0; i < area.mVertices.size(); i += 2)
+				{
+					if (!error.check(std::abs(area.mVertices[i]) <= 180.0 && std::abs(area.mVertices[i + 1]) <= 90.0,
+						"%s: vertex out of range: %f, %f", area.mName.c_str(), area.mVertices[i], area.mVertices[i + 1]))
+						return false;
+				}
+			}
+			return true;
+		}
+
+
+		double getNauticalTimezone(double longitude)
+		{
+			double wrapped = wrapLongitude(longitude);
+			return wrapped == -180.0 ? 12.0 : std::round(wrapped / 15.0);
+		}
+
+
+		bool TimeZoneIndex::build(std::vector<TimeZoneArea> areas, double cellSize, utility::ErrorState& error)
+		{
+			if (!error.check(cellSize >= 0.01 && cellSize <= 90.0, "cell size out of range: %f", cellSize))
+				return false;
+
+			if (!error.check(areas.size() < listFlag - 1, "too many timezone areas"))
+				return false;
+
+			for (const auto& area : areas)
+			{
+				if (!error.check(area.mVertices.size() % 2 == 0 && area.mVertices.size() >= 6, "%s: polygon needs at least 3 longitude, latitude pairs", area.mName.c_str()))
+					return false;
+			}
+
+			mAreas = std::move(areas);
+			mCellSize = cellSize;
+			mColumns = static_cast<int>(std::ceil(360.0 / cellSize));
+			mRows = static_cast<int>(std::ceil(180.0 / cellSize));
+			size_t cell_count = static_cast<size_t>(mColumns) * mRows;
+
+			// Area covering the whole cell + 1, set by the first area that does
+			std::vector<uint32_t> cover(cell_count, 0);
+
+			// Cell, area pairs of areas with a boundary in the cell, before the covering area
+			std::vector<std::pair<uint32_t, uint32_t>> boundaries;
+
+			for (uint32_t a = 0; a < mAreas.size(); a++)
+			{
+				const auto& vertices = mAreas[a].mVertices;
+				size_t count = vertices.size() / 2;
+				double min_x = 180.0, min_y = 90.0, max_x = -180.0, max_y = -90.0;
+				for (size_t i = 0; i < count; i++)
+				{
+					min_x = std::min(min_x, vertices[i * 2]);
+					max_x = std::max(max_x, vertices[i * 2]);
+					min_y = std::min(min_y, vertices[i * 2 + 1]);
+					max_y = std::max(max_y, vertices[i * 2 + 1]);
+				}
+
+				// Cells in the bounding box
+				int c0 = std::min(static_cast<int>((min_x + 180.0) / cellSize), mColumns - 1);
+				int c1 = std::min(static_cast<int>((max_x + 180.0) / cellSize), mColumns - 1);
+				int r0 = std::min(static_cast<int>((min_y + 90.0) / cellSize), mRows - 1);
+				int r1 = std::min(static_cast<int>((max_y + 90.0) / cellSize), mRows - 1);
+				int width = c1 - c0 + 1;
+				std::vector<bool> boundary(static_cast<size_t>(width) * (r1 - r0 + 1), false);
+
+				// Mark the cells crossed by an edge
+				for (size_t i = 0, j = count - 1; i < count; j = i++)
+				{
+					double x0 = vertices[j * 2], y0 = vertices[j * 2 + 1];
+					double x1 = vertices[i * 2], y1 = vertices[i * 2 + 1];
+					int ec0 = std::min(static_cast<int>((std::min(x0, x1) + 180.0) / cellSize), c1);
+					int ec1 = std::min(static_cast<int>((std::max(x0, x1) + 180.0) / cellSize), c1);
+					int er0 = std::min(static_cast<int>((std::min(y0, y1) + 90.0) / cellSize), r1);
+					int er1 = std::min(static_cast<int>((std::max(y0, y1) + 90.0) / cellSize), r1);
+					for (int r = er0; r <= er1; r++)
+					{
+						for (int c = ec0; c <= ec1; c++)
+						{
+							double cx = c * cellSize - 180.0, cy = r * cellSize - 90.0;
+							if (segmentIntersects(x0, y0, x1, y1, cx, cy, cx + cellSize, cy + cellSize))
+								boundary[static_cast<size_t>(r - r0) * width + (c - c0)] = true;
+						}
+					}
+				}
+
+				// Cells without an edge are entirely inside or outside, the center decides
+				for (int r = r0; r <= r1; r++)
+				{
+					for (int c = c0; c <= c1; c++)
+					{
+						size_t cell = static_cast<size_t>(r) * mColumns + c;
+						if (cover[cell] != 0)
+							continue;
+
+						if (boundary[static_cast<size_t>(r - r0) * width + (c - c0)])
+							boundaries.emplace_back(static_cast<uint32_t>(cell), a);
+						else if (mAreas[a].contains((r + 0.5) * cellSize - 90.0, (c + 0.5) * cellSize - 180.0))
+							cover[cell] = a + 1;
+					}
+				}
+			}
+
+			// Areas were added in order of precedence, keep it within every cell
+			std::stable_sort(boundaries.begin(), boundaries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+			mCells = std::move(cover);
+			mLists.clear();
+			for (size_t i = 0; i < boundaries.size();)
+			{
+				uint32_t cell = boundaries[i].first;
+				size_t end = i;
+				while (end < boundaries.size() && boundaries[end].first == cell)
+					end++;
+
+				if (!error.check(mLists.size() < listFlag, "too many boundary cells, increase the cell size"))
+					return false;
+
+				uint32_t offset = static_cast<uint32_t>(mLists.size());
+				mLists.emplace_back(static_cast<uint32_t>(end - i));
+				mLists.emplace_back(mCells[cell]);
+				for (; i < end; i++)
+					mLists.emplace_back(boundaries[i].second);
+				mCells[cell] = offset | listFlag;
+			}
+			return true;
+		}
+
+
+		int TimeZoneIndex::findArea(double latitude, double longitude) const
+		{
+			// NaN passes the clamps below and would index outside of the grid
+			if (mCells.empty() || !std::isfinite(latitude) || !std::isfinite(longitude))
+				return -1;
+
+			longitude = wrapLongitude(longitude);
+			latitude = std::min(std::max(latitude, -90.0), 90.0);
+			int column = std::min(static_cast<int>((longitude + 180.0) / mCellSize), mColumns - 1);
+			int row = std::min(static_cast<int>((latitude + 90.0) / mCellSize), mRows - 1);
+			uint32_t cell = mCells[static_cast<size_t>(row) * mColumns + column];
+			if ((cell & listFlag) == 0)
+				return static_cast<int>(cell) - 1;
+
+			// Test the candidates in order of precedence, the covering area holds the rest of the cell
+			const uint32_t* list = mLists.data() + (cell & ~listFlag);
+			for (uint32_t i = 0; i < list[0]; i++)
+			{
+				uint32_t area = list[2 + i];
+				if (mAreas[area].contains(latitude, longitude))
+					return static_cast<int>(area);
+			}
+			return static_cast<int>(list[1]) - 1;
+		}
+
+
+		double TimeZoneIndex::getTimezone(double latitude, double longitude) const
+		{
+			int area = findArea(latitude, longitude);
+			return area < 0 ? getNauticalTimezone(longitude) : mAreas[area].mOffset;
+		}
+
+
+		void TimeZoneIndex::resolve(Location* locations, size_t count) const
+		{
+			for (size_t i = 0; i < count; i++)
+				locations[i].mTimezone = getTimezone(locations[i].mLatitude, locations[i].mLongitude);
+		}
+
+
+		size_t TimeZoneIndex::getMemoryUsage() const
+		{
+			return (mCells.size() + mLists.size()) * sizeof(uint32_t);
+		}
+	}
+}
@@ -0,0 +1,132 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "sunsetevents.h"
+
+#include <utility/dllexport.h>
+#include <utility/errorstate.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Area with a single standard timezone offset, bounded by a simple polygon.
+		 */
+		struct NAPAPI TimeZoneArea
+		{
+			double mOffset = 0.0;						///< Standard timezone offset in hours, excluding daylight saving
+			std::string mName;							///< Name of the area
+			std::vector<double> mVertices;				///< Polygon as longitude, latitude pairs in degrees, implicitly closed
+
+			/**
+			 * @param latitude latitude in degrees
+			 * @param longitude longitude in degrees
+			 * @return if the point is inside the polygon
+			 */
+			bool contains(double latitude, double longitude) const;
+		};
+
+		/**
+		 * Parses timezone areas from text. Every area starts with a line 'zone <offset> <name>',
+		 * followed by the polygon as longitude latitude pairs in degrees, separated by white space or new lines.
+		 * Everything after '#' on a line is ignored.
+		 * @param text the areas
+		 * @param outAreas receives the areas, in order
+		 * @param error contains the error if the text is invalid
+		 * @return if the text is valid
+		 */
+		bool NAPAPI parseTimeZones(const std::string& text, std::vector<TimeZoneArea>& outAreas, utility::ErrorState& error);
+
+		/**
+		 * Bundled timezone areas, in the format read by parseTimeZones().
+		 * Boundaries are heavily simplified, within tens of kilometers of the real border at best,
+		 * and only cover areas where the standard offset differs from the nautical timezone of the longitude.
+		 * @return the bundled areas
+		 */
+		NAPAPI const char* getBundledTimeZones();
+
+		/**
+		 * Timezone offset of the nautical timezone of a longitude: 15 degree bands centered on Greenwich.
+		 * @param longitude longitude in degrees
+		 * @return offset in whole hours
+		 */
+		double NAPAPI getNauticalTimezone(double longitude);
+
+
+		/**
+		 * Looks up the standard timezone of a location from a set of timezone areas, in constant time for most locations.
+		 *
+		 * The globe is divided into a grid of cells. A cell inside a single area resolves to it directly,
+		 * only cells on a boundary keep a short list of candidate areas that are tested with a point in polygon test.
+		 * Areas earlier in the list take precedence where areas overlap, which allows enclaves to be listed
+		 * before the area that surrounds them. Locations outside all areas get the nautical timezone of their longitude.
+		 */
+		class NAPAPI TimeZoneIndex
+		{
+		public:
+			/**
+			 * Builds the index.
+			 * @param areas timezone areas, earlier areas take precedence
+			 * @param cellSize size of a grid cell in degrees, smaller cells have fewer candidates but use more memory
+			 * @param error contains the error if the areas or cell size are invalid
+			 * @return if the index was built
+			 */
+			bool build(std::vector<TimeZoneArea> areas, double cellSize, utility::ErrorState& error);
+
+			/**
+			 * @param latitude latitude in degrees
+			 * @param longitude longitude in degrees
+			 * @return index of the area that contains the location, -1 if none does or the location isn't finite
+			 */
+			int findArea(double latitude, double longitude) const;
+
+			/**
+			 * @param latitude latitude in degrees
+			 * @param longitude longitude in degrees
+			 * @return standard timezone offset in hours of the location, the nautical timezone outside all areas, NaN for a non-finite longitude
+			 */
+			double getTimezone(double latitude, double longitude) const;
+
+			/**
+			 * Sets the timezone of all locations, see getTimezone().
+			 * @param locations the locations to resolve
+			 * @param count number of locations
+			 */
+			void resolve(Location* locations, size_t count) const;
+
+			/**
+			 * Sets the timezone of all locations, see getTimezone().
+			 * @param locations the locations to resolve
+			 */
+			void resolve(std::vector<Location>& locations) const				{ resolve(locations.data(), locations.size()); }
+
+			/**
+			 * @return the areas of the index
+			 */
+			const std::vector<TimeZoneArea>& getAreas() const					{ return mAreas; }
+
+			/**
+			 * @return size of the grid and candidate lists in bytes
+			 */
+			size_t getMemoryUsage() const;
+
+		private:
+			// Cells with this bit set refer to a candidate list, otherwise they hold the area index + 1, 0 for none
+			static constexpr uint32_t listFlag = 0x80000000u;
+
+			std::vector<TimeZoneArea> mAreas;
+			double mCellSize = 1.0;
+			int mColumns = 0;
+			int mRows = 0;
+			std::vector<uint32_t> mCells;		///< Area index + 1 or candidate list offset, row major from the south west
+			std::vector<uint32_t> mLists;		///< Candidate lists: count, area index + 1 covering the rest of the cell, candidates
+		};
+	}
+}
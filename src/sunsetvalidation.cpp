@@ -0,0 +1,143 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "sunsetvalidation.h"
+
+#include <sunset.h>
+#include <chrono>
+#include <limits>
+#include <cmath>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Golden sample: location, date and the expected local sunrise / sunset in minutes past midnight.
+		 * NaN indicates the sun doesn't rise or set on that day (polar day or night).
+		 */
+		struct GoldenSample
+		{
+			double mLatitude;
+			double mLongitude;
+			int mTimezone;
+			int mYear;
+			int mMonth;
+			int mDay;
+			double mSunrise;
+			double mSunset;
+		};
+
+		static constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+		// Equator, mid-latitudes, polar circles (including polar day & night) and one sample for every timezone from -12 to +14
+		static const GoldenSample goldenTable[] =
+		{
+		{    0.00,     0.00,   0, 2024,  3, 20, 364.032057, 1090.546191 },
+		{    0.00,     0.00,   0, 2024,  6, 21, 358.238615, 1085.611541 },
+		{    0.00,     0.00,   0, 2024, 12, 21, 354.564435, 1082.078208 },
+		{    0.00,   -78.50,  -5, 2025,  9, 23, 362.983280, 1089.470711 },
+		{    0.00,   109.30,   7, 2023,  1, 15, 348.346779, 1075.673731 },
+		{   52.37,     4.90,   1, 2024,  6, 21, 258.100756, 1266.520545 },
+		{   52.37,     4.90,   1, 2024, 12, 21, 528.390739, 989.040221 },
+		{   48.85,     2.35,   1, 2025,  3, 20, 413.196253, 1143.644050 },
+		{   40.71,   -74.01,  -5, 2024,  9, 22, 344.124359, 1072.269477 },
+		{  -33.87,   151.21,  10, 2024,  6, 21, 420.061514, 1013.928207 },
+		{  -33.87,   151.21,  10, 2024, 12, 21, 280.872899, 1145.678241 },
+		{   35.68,   139.69,   9, 2030,  4,  1, 328.411138, 1082.535307 },
+		{  -34.60,   -58.38,  -3, 2020,  2, 29, 400.395258, 1170.852853 },
+		{   66.56,    25.73,   2, 2024,  3, 20, 375.905028, 1114.740288 },
+		{   66.56,    25.73,   2, 2024,  9, 22, 360.095026, 1097.405455 },
+		{  -66.56,   110.00,   7, 2024,  3, 20, 338.404526, 1074.485908 },
+		{  -66.56,   110.00,   7, 2024,  9, 22, 326.511203, 1060.670283 },
+		{   78.22,    15.65,   1, 2024,  6, 21, NaN, NaN },
+		{   78.22,    15.65,   1, 2024, 12, 21, NaN, NaN },
+		{  -77.85,   166.67,  12, 2024,  6, 21, NaN, NaN },
+		{  -45.00,  -176.50, -12, 2000,  1,  1, 243.122626, 1175.657699 },
+		{  -20.00,  -168.50, -11, 2003,  2,  8, 362.185763, 1133.985737 },
+		{    5.00,  -153.50, -10, 2006,  3, 15, 380.248887, 1105.461618 },
+		{   30.00,  -138.50,  -9, 2009,  4, 22, 339.365584, 1125.884764 },
+		{   55.00,  -123.50,  -8, 2012,  5,  1, 272.521215, 1190.784482 },
+		{  -45.00,  -108.50,  -7, 2015,  6,  8, 467.098901, 998.858470 },
+		{  -20.00,   -93.50,  -6, 2018,  7, 15, 409.077826, 1071.074543 },
+		{    5.00,   -78.50,  -5, 2021,  8, 22, 369.314029, 1104.193124 },
+		{   30.00,   -63.50,  -4, 2024,  9,  1, 351.316606, 1115.835790 },
+		{   55.00,   -48.50,  -3, 2027, 10,  8, 389.482912, 1052.636695 },
+		{  -45.00,   -33.50,  -2, 2030, 11, 15, 275.017056, 1162.872839 },
+		{  -20.00,   -18.50,  -1, 2033, 12, 22, 332.373563, 1133.082066 },
+		{    5.00,    -3.50,   0, 2036,  1,  1, 382.118554, 1092.591088 },
+		{   30.00,    11.50,   1, 2039,  2,  8, 419.762655, 1076.869069 },
+		{   55.00,    26.50,   2, 2002,  3, 15, 389.907579, 1097.146743 },
+		{  -45.00,    41.50,   3, 2005,  4, 22, 417.620985, 1046.753020 },
+		{  -20.00,    56.50,   4, 2008,  5,  1, 390.036674, 1071.867216 },
+		{    5.00,    71.50,   5, 2011,  6,  8, 360.841415, 1105.081150 },
+		{   30.00,    86.50,   6, 2014,  7, 15, 322.894181, 1156.754974 },
+		{   55.00,   101.50,   7, 2017,  8, 22, 301.242548, 1171.299838 },
+		{  -45.00,   116.50,   8, 2020,  9,  1, 402.404323, 1066.221870 },
+		{  -20.00,   131.50,   9, 2023, 10,  8, 349.977121, 1093.759157 },
+		{    5.00,   146.50,  10, 2026, 11, 15, 361.581629, 1075.337944 },
+		{   30.00,   161.50,  11, 2029, 12, 22, 426.023431, 1038.936958 },
+		{   55.00,   176.50,  12, 2032,  1,  1, 518.952359, 955.453388 },
+		{  -45.00,  -168.50,  13, 2035,  2,  8, 1761.369553, 2614.099177 },
+		{  -20.00,  -153.50,  14, 2038,  3, 15, 1816.454687, 2548.695009 },
+		};
+
+		// Number of times the golden table is evaluated to measure the average call time
+		static constexpr int timingRuns = 1000;
+
+
+		// Returns deviation in seconds, 0 when both are NaN, infinity when only one of them is NaN
+		static double drift(double computed, double expected)
+		{
+			if (std::isnan(computed) || std::isnan(expected))
+				return std::isnan(computed) == std::isnan(expected) ? 0.0 : std::numeric_limits<double>::infinity();
+			return std::abs(computed - expected) * 60.0;
+		}
+
+
+		bool validate(double tolerance, double budget, ValidationResult& outResult, utility::ErrorState& error)
+		{
+			outResult = ValidationResult();
+			SunSet model;
+
+			// Compare against golden table
+			for (const auto& sample : goldenTable)
+			{
+				model.setCurrentDate(sample.mYear, sample.mMonth, sample.mDay);
+				model.setPosition(sample.mLatitude, sample.mLongitude, sample.mTimezone);
+				double sunrise_drift = drift(model.calcSunrise(), sample.mSunrise);
+				double sunset_drift = drift(model.calcSunset(), sample.mSunset);
+				outResult.mMaxDrift = std::max(outResult.mMaxDrift, std::max(sunrise_drift, sunset_drift));
+				outResult.mSampleCount++;
+
+				if (!error.check(sunrise_drift <= tolerance && sunset_drift <= tolerance,
+					"Drift of %.3f seconds exceeds tolerance of %.3f seconds (lat: %.2f, lon: %.2f, tz: %d, date: %04d-%02d-%02d)",
+					std::max(sunrise_drift, sunset_drift), tolerance, sample.mLatitude, sample.mLongitude,
+					sample.mTimezone, sample.mYear, sample.mMonth, sample.mDay))
+					return false;
+			}
+
+			// Measure average time per sunrise + sunset pair
+			// Results accumulate into a volatile sink that is read back, which prevents the timing loop from being optimized away
+			volatile double sink = 0.0;
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < timingRuns; i++)
+			{
+				for (const auto& sample : goldenTable)
+				{
+					model.setCurrentDate(sample.mYear, sample.mMonth, sample.mDay);
+					model.setPosition(sample.mLatitude, sample.mLongitude, sample.mTimezone);
+					sink = sink + model.calcSunrise() + model.calcSunset();
+				}
+			}
+			auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start);
+			double checksum = sink;
+			static_cast<void>(checksum);
+			outResult.mCallTime = elapsed.count() / static_cast<double>(timingRuns * outResult.mSampleCount);
+
+			return error.check(outResult.mCallTime <= budget,
+				"Average call time of %.3f microseconds exceeds budget of %.3f microseconds", outResult.mCallTime, budget);
+		}
+	}
+}
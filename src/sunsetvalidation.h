@@ -0,0 +1,38 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <utility/dllexport.h>
+#include <utility/errorstate.h>
+
+namespace nap
+{
+	namespace sunset
+	{
+		/**
+		 * Outcome of a sunset model validation run.
+		 */
+		struct ValidationResult
+		{
+			int mSampleCount = 0;				///< Number of golden samples that were compared
+			double mMaxDrift = 0.0;				///< Largest absolute deviation from the golden table in seconds
+			double mCallTime = 0.0;				///< Average time it takes to compute one sunrise + sunset pair in microseconds
+		};
+
+		/**
+		 * Validates the sunset model against a stored golden table of sunrise and sunset times.
+		 * The table covers the equator, mid-latitudes, the polar circles and every timezone from -12 to +14.
+		 * Validation fails when the sunrise or sunset of any sample drifts more than 'tolerance' seconds
+		 * from the stored value, or when computing a sunrise + sunset pair takes longer than 'budget' microseconds on average.
+		 * Run this after changing the model to verify it hasn't drifted or become slower.
+		 * @param tolerance maximum allowed deviation from the golden table in seconds
+		 * @param budget maximum allowed average time per sunrise + sunset pair in microseconds
+		 * @param outResult holds the measured drift and call time, also when validation fails
+		 * @param error contains the error if validation fails
+		 * @return if the model is within tolerance and budget
+		 */
+		bool NAPAPI validate(double tolerance, double budget, ValidationResult& outResult, utility::ErrorState& error);
+	}
+}
@@ -0,0 +1,168 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+/**
+ * sunsetbench: reports cost and accuracy of every sunrise / sunset engine side by side.
+ *
+ * Every engine computes sunrise and sunset for a grid of locations over a full year.
+ * Cost is the average time per sunrise + sunset pair, accuracy is the deviation from the Precise (SPA) engine.
+ * The Baked engine falls back to NOAA on the grid: when a table is baked (NAPSUNSET_BAKE) it is also compared
+ * to NOAA, which it reproduces, on every day of the baked years at the baked location.
+ *
+ * Usage: sunsetbench [max latitude, default: 60]
+ */
+
+#include <sunsetengine.h>
+#include <sunsetbaked.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace nap::sunset;
+
+struct Sample
+{
+	double mLatitude;
+	double mLongitude;
+	double mTimezone;
+	int mYear;
+	int mMonth;
+	int mDay;
+};
+
+struct Result
+{
+	double mCallTime = 0.0;		///< Average time per sunrise + sunset pair in nanoseconds
+	double mMaxError = 0.0;		///< Max deviation from reference in seconds
+	double mMeanError = 0.0;	///< Mean deviation from reference in seconds
+	int mMissed = 0;			///< Samples where the engine and reference disagree on the sun rising
+};
+
+
+static std::vector<double> run(EEngine type, const std::vector<Sample>& samples, double& outCallTime)
+{
+	auto engine = createEngine(type);
+	std::vector<double> times(samples.size() * 2);
+	auto start = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		const auto& sample = samples[i];
+		engine->setDate(sample.mYear, sample.mMonth, sample.mDay);
+		engine->setPosition(sample.mLatitude, sample.mLongitude, sample.mTimezone);
+		times[i * 2 + 0] = engine->calcSunrise();
+		times[i * 2 + 1] = engine->calcSunset();
+	}
+	auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start);
+	outCallTime = elapsed.count() / static_cast<double>(samples.size());
+	return times;
+}
+
+
+int main(int argc, char* argv[])
+{
+	double max_latitude = argc > 1 ? std::atof(argv[1]) : 60.0;
+
+	// Location grid over a full year, timezone follows longitude
+	std::vector<Sample> samples;
+	for (double lat = -max_latitude; lat <= max_latitude; lat += 2.5)
+	{
+		for (double lon = -180.0; lon < 180.0; lon += 15.0)
+		{
+			for (int month = 1; month <= 12; month++)
+			{
+				for (int day = 1; day <= 28; day += 3)
+					samples.push_back({ lat, lon + 3.7, std::round(lon / 15.0), 2024, month, day });
+			}
+		}
+	}
+
+	const EEngine engines[] = { EEngine::Precise, EEngine::NOAA, EEngine::Fast, EEngine::Baked };
+	const char* names[] = { "Precise", "NOAA", "Fast", "Baked" };
+	constexpr int engineCount = sizeof(engines) / sizeof(engines[0]);
+
+	double reference_time = 0.0;
+	std::vector<double> reference = run(EEngine::Precise, samples, reference_time);
+
+	std::printf("%zu samples, latitudes within %.1f degrees, accuracy relative to Precise\n\n", samples.size(), max_latitude);
+	std::printf("%-10s %14s %16s %16s %8s\n", "engine", "time (ns)", "max error (s)", "mean error (s)", "missed");
+	for (int e = 0; e < engineCount; e++)
+	{
+		Result result;
+		std::vector<double> times = e == 0 ? reference : run(engines[e], samples, result.mCallTime);
+		if (e == 0)
+			result.mCallTime = reference_time;
+
+		int compared = 0;
+		for (size_t i = 0; i < times.size(); i++)
+		{
+			if (std::isnan(times[i]) != std::isnan(reference[i]))
+			{
+				result.mMissed++;
+				continue;
+			}
+			if (std::isnan(times[i]))
+				continue;
+
+			double error = std::abs(times[i] - reference[i]) * 60.0;
+			result.mMaxError = std::max(result.mMaxError, error);
+			result.mMeanError += error;
+			compared++;
+		}
+		result.mMeanError = compared > 0 ? result.mMeanError / compared : 0.0;
+		std::printf("%-10s %14.1f %16.2f %16.2f %8d\n", names[e], result.mCallTime, result.mMaxError, result.mMeanError, result.mMissed);
+	}
+
+	// Baked table against the NOAA model it reproduces, every day of the baked years
+	BakedInfo baked = getBakedInfo();
+	if (!baked.mAvailable)
+	{
+		std::printf("\nno table baked, configure with NAPSUNSET_BAKE to benchmark the Baked engine at its location\n");
+		return 0;
+	}
+
+	std::vector<Sample> baked_samples;
+	for (int year = baked.mFirstYear; year < baked.mFirstYear + baked.mYears; year++)
+	{
+		for (int month = 1; month <= 12; month++)
+		{
+			static const int days[] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+			bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+			int day_count = month == 2 && !leap ? 28 : days[month - 1];
+			for (int day = 1; day <= day_count; day++)
+				baked_samples.push_back({ baked.mLatitude, baked.mLongitude, std::round(baked.mLongitude / 15.0), year, month, day });
+		}
+	}
+
+	Result noaa, table;
+	std::vector<double> noaa_times = run(EEngine::NOAA, baked_samples, noaa.mCallTime);
+	std::vector<double> table_times = run(EEngine::Baked, baked_samples, table.mCallTime);
+	int compared = 0;
+	for (size_t i = 0; i < table_times.size(); i++)
+	{
+		if (std::isnan(table_times[i]) != std::isnan(noaa_times[i]))
+		{
+			table.mMissed++;
+			continue;
+		}
+		if (std::isnan(table_times[i]))
+			continue;
+
+		double error = std::abs(table_times[i] - noaa_times[i]) * 60.0 * 1000.0;
+		table.mMaxError = std::max(table.mMaxError, error);
+		table.mMeanError += error;
+		compared++;
+	}
+	table.mMeanError = compared > 0 ? table.mMeanError / compared : 0.0;
+
+	std::printf("\n%zu days at the baked location (%.4f, %.4f), %d - %d, accuracy relative to NOAA\n\n",
+		baked_samples.size(), baked.mLatitude, baked.mLongitude, baked.mFirstYear, baked.mFirstYear + baked.mYears - 1);
+	std::printf("%-10s %14s %16s %16s %8s\n", "engine", "time (ns)", "max error (ms)", "mean error (ms)", "missed");
+	std::printf("%-10s %14.1f %16.2f %16.2f %8d\n", "NOAA", noaa.mCallTime, 0.0, 0.0, 0);
+	std::printf("%-10s %14.1f %16.2f %16.2f %8d\n", "Baked", table.mCallTime, table.mMaxError, table.mMeanError, table.mMissed);
+	return 0;
+}
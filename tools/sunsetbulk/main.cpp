@@ -0,0 +1,362 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+/**
+ * sunsetbulk: headless bulk sunrise / sunset generator.
+ *
+ * Streams a CSV of sites (id,latitude,longitude,timezone) in and writes the sunrise & sunset,
+ * in minutes past local midnight, for every site and day of the requested period to a CSV or binary table.
+ * Sites are read in blocks, every block is split into small chunks that are claimed by the workers
+ * from a shared counter, which keeps all cores busy regardless of chunk cost.
+ * Chunks are written in input order as soon as they are completed, only one block is kept in memory.
+ *
+ * Usage: sunsetbulk -i sites.csv -o events.csv [-f csv|binary] [-p double|float] [-s 2024-01-01] [-d 365] [-t threads]
+ */
+
+#include <sunset.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Number of sites read from the input before processing
+static constexpr size_t blockSize = 1 << 16;
+
+// Number of sites processed by a worker in one go
+static constexpr size_t chunkSize = 256;
+
+// Binary output header identifier and version
+static constexpr char binaryMagic[4] = { 'S', 'U', 'N', 'B' };
+static constexpr uint32_t binaryVersion = 1;
+
+/**
+ * Output format
+ */
+enum class EFormat
+{
+	CSV,				///< Text: id,date,sunrise,sunset
+	Binary				///< Header followed by fixed size records
+};
+
+/**
+ * Single site read from input
+ */
+struct Site
+{
+	std::string mID;
+	double mLatitude = 0.0;
+	double mLongitude = 0.0;
+	double mTimezone = 0.0;
+};
+
+/**
+ * Binary output record, one for every site-day
+ */
+struct Record
+{
+	uint32_t mSite;		///< Zero based index of the site in the input
+	int32_t mDay;		///< Days since 1970-01-01
+	float mSunrise;		///< Sunrise in minutes past local midnight, NaN if the sun doesn't rise
+	float mSunset;		///< Sunset in minutes past local midnight, NaN if the sun doesn't set
+};
+
+/**
+ * Days since 1970-01-01 for the given civil date
+ */
+static int32_t daysFromCivil(int y, int m, int d)
+{
+	y -= m <= 2;
+	const int era = (y >= 0 ? y : y - 399) / 400;
+	const int yoe = y - era * 400;
+	const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + doe - 719468;
+}
+
+/**
+ * Civil date for the given number of days since 1970-01-01
+ */
+static void civilFromDays(int32_t z, int& y, int& m, int& d)
+{
+	z += 719468;
+	const int era = (z >= 0 ? z : z - 146096) / 146097;
+	const int doe = z - era * 146097;
+	const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	const int mp = (5 * doy + 2) / 153;
+	d = doy - (153 * mp + 2) / 5 + 1;
+	m = mp < 10 ? mp + 3 : mp - 9;
+	y = yoe + era * 400 + (m <= 2);
+}
+
+
+/**
+ * Parses a single CSV line: id,latitude,longitude,timezone
+ */
+static bool parseSite(const std::string& line, Site& outSite)
+{
+	size_t c0 = line.find(',');
+	if (c0 == std::string::npos)
+		return false;
+
+	const char* cursor = line.c_str() + c0 + 1;
+	char* end = nullptr;
+	double values[3];
+	for (int i = 0; i < 3; i++)
+	{
+		values[i] = std::strtod(cursor, &end);
+		if (end == cursor || (i < 2 && *end != ','))
+			return false;
+		cursor = end + 1;
+	}
+
+	outSite.mID = line.substr(0, c0);
+	outSite.mLatitude = values[0];
+	outSite.mLongitude = values[1];
+	outSite.mTimezone = values[2];
+	return true;
+}
+
+
+/**
+ * Computes all site-days for a range of sites and serializes them into the given buffer
+ */
+template<typename T>
+static void processChunk(const Site* sites, size_t count, uint32_t firstIndex, int32_t startDay, int days, EFormat format, std::string& outBuffer)
+{
+	// Resolve the date of every day once
+	std::vector<int> ymd(days * 3);
+	for (int i = 0; i < days; i++)
+		civilFromDays(startDay + i, ymd[i * 3], ymd[i * 3 + 1], ymd[i * 3 + 2]);
+
+	BasicSunSet<T> model;
+	outBuffer.clear();
+	char line[128];
+	for (size_t s = 0; s < count; s++)
+	{
+		const Site& site = sites[s];
+		model.setPosition(static_cast<T>(site.mLatitude), static_cast<T>(site.mLongitude), static_cast<T>(site.mTimezone));
+		for (int i = 0; i < days; i++)
+		{
+			const int* date = &ymd[i * 3];
+			model.setCurrentDate(date[0], date[1], date[2]);
+			double sunrise = static_cast<double>(model.calcSunrise());
+			double sunset = static_cast<double>(model.calcSunset());
+
+			if (format == EFormat::CSV)
+			{
+				int len = std::snprintf(line, sizeof(line), "%s,%04d-%02d-%02d,%.3f,%.3f\n",
+					site.mID.c_str(), date[0], date[1], date[2], sunrise, sunset);
+				outBuffer.append(line, len);
+			}
+			else
+			{
+				Record record = { firstIndex + static_cast<uint32_t>(s), startDay + i, static_cast<float>(sunrise), static_cast<float>(sunset) };
+				outBuffer.append(reinterpret_cast<const char*>(&record), sizeof(Record));
+			}
+		}
+	}
+}
+
+
+/**
+ * Processes a block of sites on all workers and writes the chunks to output, in order, as they are completed
+ */
+static void processBlock(const std::vector<Site>& sites, uint32_t firstIndex, int32_t startDay, int days, EFormat format, bool singlePrecision, int threadCount, std::ostream& output)
+{
+	const size_t chunk_count = (sites.size() + chunkSize - 1) / chunkSize;
+	std::vector<std::string> buffers(chunk_count);
+	std::unique_ptr<std::atomic<bool>[]> done(new std::atomic<bool>[chunk_count]);
+	for (size_t i = 0; i < chunk_count; i++)
+		done[i] = false;
+
+	std::atomic<size_t> next_chunk = { 0 };
+	std::mutex mutex;
+	std::condition_variable completed;
+
+	// Workers claim the next available chunk until all chunks are processed
+	auto work = [&]()
+	{
+		size_t chunk;
+		while ((chunk = next_chunk.fetch_add(1)) < chunk_count)
+		{
+			size_t first = chunk * chunkSize;
+			size_t count = std::min(chunkSize, sites.size() - first);
+			if (singlePrecision)
+				processChunk<float>(&sites[first], count, firstIndex + static_cast<uint32_t>(first), startDay, days, format, buffers[chunk]);
+			else
+				processChunk<double>(&sites[first], count, firstIndex + static_cast<uint32_t>(first), startDay, days, format, buffers[chunk]);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				done[chunk] = true;
+			}
+			completed.notify_one();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threadCount; i++)
+		workers.emplace_back(work);
+
+	// Write chunks in order, release memory as soon as a chunk is written
+	for (size_t i = 0; i < chunk_count; i++)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			completed.wait(lock, [&]() { return done[i].load(); });
+		}
+		output.write(buffers[i].data(), buffers[i].size());
+		std::string().swap(buffers[i]);
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+}
+
+
+static void printUsage()
+{
+	std::printf(
+		"Usage: sunsetbulk -i <sites.csv> -o <output> [options]\n"
+		"  -i <file>     input CSV: id,latitude,longitude,timezone (standard offset in hours)\n"
+		"  -o <file>     output file\n"
+		"  -f <format>   output format: csv (default) or binary\n"
+		"  -p <type>     precision: double (default) or float, float deviates less than 2 seconds up to the polar circles\n"
+		"  -s <date>     first day, yyyy-mm-dd (default: 2024-01-01)\n"
+		"  -d <days>     number of days (default: 365)\n"
+		"  -t <threads>  number of worker threads (default: all cores)\n");
+}
+
+
+int main(int argc, char* argv[])
+{
+	std::string input_path, output_path;
+	EFormat format = EFormat::CSV;
+	bool single_precision = false;
+	int year = 2024, month = 1, day = 1;
+	int days = 365;
+	int thread_count = static_cast<int>(std::thread::hardware_concurrency());
+
+	// Parse arguments
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			printUsage();
+			return -1;
+		}
+
+		std::string value = argv[++i];
+		if (arg == "-i")
+			input_path = value;
+		else if (arg == "-o")
+			output_path = value;
+		else if (arg == "-f" && (value == "csv" || value == "binary"))
+			format = value == "csv" ? EFormat::CSV : EFormat::Binary;
+		else if (arg == "-p" && (value == "double" || value == "float"))
+			single_precision = value == "float";
+		else if (arg == "-s" && std::sscanf(value.c_str(), "%d-%d-%d", &year, &month, &day) == 3)
+			continue;
+		else if (arg == "-d")
+			days = std::atoi(value.c_str());
+		else if (arg == "-t")
+			thread_count = std::atoi(value.c_str());
+		else
+		{
+			printUsage();
+			return -1;
+		}
+	}
+
+	if (input_path.empty() || output_path.empty() || days <= 0)
+	{
+		printUsage();
+		return -1;
+	}
+	thread_count = std::max(thread_count, 1);
+
+	std::ifstream input(input_path);
+	if (!input)
+	{
+		std::fprintf(stderr, "error: unable to open input: %s\n", input_path.c_str());
+		return -1;
+	}
+
+	std::ofstream output(output_path, std::ios::binary);
+	if (!output)
+	{
+		std::fprintf(stderr, "error: unable to open output: %s\n", output_path.c_str());
+		return -1;
+	}
+
+	// Write header
+	int32_t start_day = daysFromCivil(year, month, day);
+	if (format == EFormat::CSV)
+	{
+		output << "id,date,sunrise,sunset\n";
+	}
+	else
+	{
+		output.write(binaryMagic, sizeof(binaryMagic));
+		output.write(reinterpret_cast<const char*>(&binaryVersion), sizeof(binaryVersion));
+		output.write(reinterpret_cast<const char*>(&start_day), sizeof(start_day));
+		output.write(reinterpret_cast<const char*>(&days), sizeof(days));
+	}
+
+	// Stream sites block by block
+	auto start = std::chrono::steady_clock::now();
+	std::vector<Site> block;
+	block.reserve(blockSize);
+	uint32_t site_count = 0;
+	size_t line_number = 0;
+	std::string line;
+	while (true)
+	{
+		bool eof = !std::getline(input, line);
+		if (!eof)
+		{
+			line_number++;
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+
+			Site site;
+			if (parseSite(line, site))
+				block.emplace_back(std::move(site));
+			else if (!line.empty() && line_number > 1)
+				std::fprintf(stderr, "warning: skipping invalid line %zu: %s\n", line_number, line.c_str());
+		}
+
+		if (block.size() == blockSize || (eof && !block.empty()))
+		{
+			processBlock(block, site_count, start_day, days, format, single_precision, thread_count, output);
+			site_count += static_cast<uint32_t>(block.size());
+			block.clear();
+		}
+
+		if (eof)
+			break;
+	}
+	output.flush();
+
+	// Report throughput
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	double site_days = static_cast<double>(site_count) * days;
+	std::printf("%u sites, %.0f site-days in %.3f seconds (%.2f million site-days per second, %d threads)\n",
+		site_count, site_days, elapsed, elapsed > 0.0 ? site_days / elapsed / 1.0e6 : 0.0, thread_count);
+
+	return output.good() ? 0 : -1;
+}
@@ -0,0 +1,37 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+/**
+ * sunsetvalidate: validates the sunset model against the golden table, see nap::sunset::validate().
+ *
+ * Prints the measured drift and call time and exits with a nonzero code when the model drifts
+ * beyond the tolerance or exceeds the time budget, for use as a test or CI step.
+ *
+ * Usage: sunsetvalidate [tolerance in seconds, default: 1] [budget in microseconds, default: 20]
+ */
+
+#include <sunsetvalidation.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char* argv[])
+{
+	double tolerance = argc > 1 ? std::atof(argv[1]) : 1.0;
+	double budget = argc > 2 ? std::atof(argv[2]) : 20.0;
+
+	nap::sunset::ValidationResult result;
+	nap::utility::ErrorState error;
+	bool valid = nap::sunset::validate(tolerance, budget, result, error);
+	std::printf("%d samples, max drift: %.3f s (tolerance: %.3f s), call time: %.3f us (budget: %.3f us)\n",
+		result.mSampleCount, result.mMaxDrift, tolerance, result.mCallTime, budget);
+
+	if (!valid)
+	{
+		std::fprintf(stderr, "validation failed: %s\n", error.toString().c_str());
+		return 1;
+	}
+	std::printf("validation passed\n");
+	return 0;
+}